@@ -0,0 +1,119 @@
+/*!*****************************************************************************
+ * @file case_fold.h
+ * @brief byte level case folding of ascii and utf-8 encoded latin letters
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _CASE_FOLD_H_
+#define _CASE_FOLD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fastdict
+{
+
+
+/* letters whose upper and lower case differ in a single byte with the
+ * same byte before it: ascii, latin-1 supplement (U+00C0 - U+00FE) and
+ * latin extended-a (U+0100 - U+017F). other letters keep their case.
+ */
+typedef enum {
+    DEA_CASE_SENSITIVE,
+    DEA_CASE_FOLD_ASCII,
+    DEA_CASE_FOLD_UTF8
+} dea_case_fold_t;
+
+
+/**************************************
+ * latin extended-a pairs, upper case
+ * on the even or the odd code point
+ *************************************/
+static inline bool latin_ext_a_lower( uint32_t cp )
+{
+    if ( ( ( cp >= 0x0100 ) && ( cp <= 0x0137 ) ) || ( ( cp >= 0x014A ) && ( cp <= 0x0177 ) ) )
+        return ( 1 == ( cp & 1 ) ) && ( 0x0131 != cp );
+    if ( ( ( cp >= 0x0139 ) && ( cp <= 0x0148 ) ) || ( ( cp >= 0x0179 ) && ( cp <= 0x017E ) ) )
+        return 0 == ( cp & 1 );
+    return false;
+}
+
+static inline bool latin_ext_a_upper( uint32_t cp )
+{
+    return ( cp != 0x0130 ) && ( cp != 0x0178 ) && latin_ext_a_lower( cp + 1 ) &&
+           ( ( cp >> 6 ) == ( ( cp + 1 ) >> 6 ) );
+}
+
+
+/**************************************
+ * the other case of byte where prev
+ * is the byte before it, or byte. to
+ * upper if upper is set.
+ *************************************/
+static inline uint8_t case_variant( uint8_t prev, uint8_t byte, bool upper, dea_case_fold_t fold )
+{
+    if ( DEA_CASE_SENSITIVE == fold )
+        return byte;
+
+    if ( upper && ( byte >= 'a' ) && ( byte <= 'z' ) )
+        return static_cast<uint8_t>( byte - 0x20 );
+    if ( !upper && ( byte >= 'A' ) && ( byte <= 'Z' ) )
+        return static_cast<uint8_t>( byte + 0x20 );
+    if ( ( DEA_CASE_FOLD_UTF8 != fold ) || ( byte < 0x80 ) || ( byte > 0xBF ) )
+        return byte;
+
+    if ( 0xC3 == prev )
+    {
+        // U+00D7 and U+00F7 are no letters, U+00DF has no upper case
+        if ( upper && ( byte >= 0xA0 ) && ( byte <= 0xBE ) && ( 0xB7 != byte ) )
+            return static_cast<uint8_t>( byte - 0x20 );
+        if ( !upper && ( byte >= 0x80 ) && ( byte <= 0x9E ) && ( 0x97 != byte ) )
+            return static_cast<uint8_t>( byte + 0x20 );
+    }
+    else if ( ( 0xC4 == prev ) || ( 0xC5 == prev ) )
+    {
+        uint32_t cp = ( static_cast<uint32_t>( prev & 0x1F ) << 6 ) | ( byte & 0x3F );
+        if ( upper && latin_ext_a_lower( cp ) && ( ( cp >> 6 ) == ( ( cp - 1 ) >> 6 ) ) )
+            return static_cast<uint8_t>( 0x80 | ( ( cp - 1 ) & 0x3F ) );
+        if ( !upper && latin_ext_a_upper( cp ) )
+            return static_cast<uint8_t>( 0x80 | ( ( cp + 1 ) & 0x3F ) );
+    }
+
+    return byte;
+}
+
+
+/**************************************
+ * lower cases data in place, the
+ * length never changes
+ *************************************/
+static inline void case_fold_lower( uint8_t* data, size_t len, dea_case_fold_t fold )
+{
+    uint8_t prev = 0;
+    for ( size_t idx = 0; idx < len; idx++ )
+    {
+        uint8_t byte = data[idx];
+        data[idx] = case_variant( prev, byte, false, fold );
+        prev = byte;
+    }
+}
+
+}
+
+#endif /* _CASE_FOLD_H_ */
@@ -0,0 +1,186 @@
+/*!*****************************************************************************
+ * @file dea_builder.h
+ * @brief trie builder allocating from an arena
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _DEA_BUILDER_H_
+#define _DEA_BUILDER_H_
+
+#include "dea.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <sys/types.h>
+#include <type_traits>
+#include <vector>
+
+namespace fastdict
+{
+
+
+static const size_t DEA_ARENA_BLOCK_SIZE     = 1 << 20;
+static const size_t DEA_BUILDER_CHUNK_STATES = 4096;
+
+
+/**************************************
+ * bump allocator for trivially
+ * destructible objects. nothing is
+ * freed before release, which frees
+ * all blocks at once.
+ *************************************/
+class DeaArena
+{
+public:
+    explicit DeaArena( size_t block_size=DEA_ARENA_BLOCK_SIZE );
+    ~DeaArena();
+
+    DeaArena( const DeaArena& ) = delete;
+    DeaArena& operator=( const DeaArena& ) = delete;
+
+    /**************************************
+     * uninitialized storage for count
+     * objects of T
+     *************************************/
+    template <typename T>
+    T* allocate( size_t count )
+    {
+        static_assert( std::is_trivially_destructible<T>::value, "arena objects are never destroyed" );
+        return static_cast<T*>( allocate_bytes( count * sizeof(T), alignof(T) ) );
+    }
+
+    /**************************************
+     *
+     *************************************/
+    void release();
+
+    /**************************************
+     * bytes of all blocks
+     *************************************/
+    size_t size_in_bytes() const { return m_reserved; }
+
+private:
+    /**************************************
+     *
+     *************************************/
+    void* allocate_bytes( size_t size, size_t alignment );
+
+private:
+    std::vector<uint8_t*> m_blocks;
+    size_t                m_block_size;
+    uint8_t*              m_current;
+    size_t                m_left;
+    size_t                m_reserved;
+};
+
+
+/* a trie transition, the transitions of a state are sorted by label */
+struct dea_builder_edge_t
+{
+    uint32_t target;
+    uint8_t  label;
+};
+
+struct dea_builder_state_t
+{
+    dea_builder_edge_t* edges;
+    uint16_t            edge_count;
+    uint16_t            edge_capacity;
+    int32_t             word_index;
+    dea_mask_t          mask;           /* categories of the accepted word */
+};
+
+
+/**************************************
+ * the trie of a word list, the input
+ * of DeaCompiled::compile. states are
+ * numbered in the order the words
+ * create them. states and transition
+ * rows live in an arena, clear drops
+ * them once the tables are compiled.
+ *************************************/
+class DeaBuilder
+{
+public:
+    DeaBuilder();
+
+    DeaBuilder( const DeaBuilder& ) = delete;
+    DeaBuilder& operator=( const DeaBuilder& ) = delete;
+
+    /**************************************
+     * adds w with the given categories.
+     * returns the index of w, which
+     * differs from index if w was added
+     * before. an empty w returns -1.
+     *************************************/
+    ssize_t add( std::string_view w, size_t index, dea_mask_t mask=DEA_DEFAULT_CATEGORY );
+
+    /**************************************
+     *
+     *************************************/
+    void clear();
+
+    /**************************************
+     *
+     *************************************/
+    bool empty() const { return 0 == m_state_count; }
+    size_t state_count() const { return m_state_count; }
+    size_t transition_count() const { return m_transition_count; }
+    size_t size_in_bytes() const { return m_arena.size_in_bytes(); }
+
+    /**************************************
+     *
+     *************************************/
+    const dea_builder_state_t& state( size_t idx ) const
+    {
+        return m_chunks[idx / DEA_BUILDER_CHUNK_STATES][idx % DEA_BUILDER_CHUNK_STATES];
+    }
+
+private:
+    /**************************************
+     *
+     *************************************/
+    dea_builder_state_t& mutable_state( size_t idx )
+    {
+        return m_chunks[idx / DEA_BUILDER_CHUNK_STATES][idx % DEA_BUILDER_CHUNK_STATES];
+    }
+
+    /**************************************
+     *
+     *************************************/
+    uint32_t new_state();
+
+    /**************************************
+     * inserts a transition at position
+     * at of the row of source
+     *************************************/
+    void insert_edge( dea_builder_state_t& source, size_t at, uint8_t label, uint32_t target );
+
+private:
+    DeaArena                          m_arena;
+    std::vector<dea_builder_state_t*> m_chunks;
+    size_t                            m_state_count;
+    size_t                            m_transition_count;
+};
+
+
+}
+
+#endif /* _DEA_BUILDER_H_ */
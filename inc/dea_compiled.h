@@ -0,0 +1,781 @@
+/*!*****************************************************************************
+ * @file dea_compiled.h
+ * @brief frozen, contiguous form of the dea used for queries
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _DEA_COMPILED_H_
+#define _DEA_COMPILED_H_
+
+#include "case_fold.h"
+#include "dea.h"
+#include "dea_builder.h"
+#include "table_memory.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+namespace fastdict
+{
+
+
+static const uint32_t DEA_COMPILED_MAGIC   = 0x54434446; /* "FDCT" */
+static const uint32_t DEA_COMPILED_VERSION = 2;
+static const uint32_t DEA_NO_STATE         = 0xFFFFFFFF;
+
+/* upper bound of the lanes of an interleaved scan */
+static const size_t   DEA_MAX_SCAN_LANES = 16;
+
+/* states placed breadth first before the layout continues depth first */
+static const size_t   DEA_LAYOUT_BFS_STATES = 2048;
+
+/* bytes a limited query scans between two looks at deadline and cancel */
+static const size_t   DEA_QUERY_CHECK_BYTES = 1024;
+
+/* the hybrid encoding searches rows up to this many transitions with a
+ * single 16 byte compare, larger rows get a dense table of 256 targets
+ */
+static const size_t   DEA_SPARSE_TRANSITIONS = 16;
+static const size_t   DEA_MAX_DENSE_STATES   = 4096;
+
+
+/* how goto_state finds the transition of a state */
+typedef enum {
+    DEA_ENCODING_UNIFORM,     /* every row searched linearly or binary */
+    DEA_ENCODING_HYBRID       /* chains, 16 byte key compare and dense rows */
+} dea_encoding_t;
+
+
+/* states of the compiled tables by the way their row is searched. chain
+ * states are the single transition states inside a chain, which walks
+ * over them compare the chain bytes at once.
+ */
+struct dea_encoding_stats_t
+{
+    size_t leaf_states;           /* no transition */
+    size_t single_states;         /* one transition */
+    size_t chain_states;          /* one transition, skipped by a chain */
+    size_t sparse_states;         /* up to DEA_SPARSE_TRANSITIONS */
+    size_t dense_states;          /* more, with a dense table */
+    size_t binary_states;         /* more, beyond DEA_MAX_DENSE_STATES */
+    size_t dense_bytes;
+};
+
+
+/* order of the states in the compiled tables */
+typedef enum {
+    DEA_LAYOUT_INSERTION,     /* as created while loading the list */
+    DEA_LAYOUT_BFS,           /* shallow states breadth first, then depth first */
+    DEA_LAYOUT_PROFILE        /* most visited states first */
+} dea_layout_t;
+
+
+/* where a word must lie in the input for an anchored query */
+typedef enum {
+    DEA_ANCHOR_PREFIX,            /* words the input starts with */
+    DEA_ANCHOR_SUFFIX,            /* words the input ends with */
+    DEA_ANCHOR_FULL               /* the whole input */
+} dea_anchor_t;
+
+
+/* how segment chooses among the splits of a word */
+typedef enum {
+    DEA_SEGMENT_FEWEST_PARTS,     /* fewest parts, then fewest linking bytes */
+    DEA_SEGMENT_LONGEST_PARTS     /* largest sum of squared part lengths */
+} dea_segment_mode_t;
+
+
+/* one part of a segmented word. link_length bytes of a linking element
+ * lie between the previous part and this one.
+ */
+struct dea_segment_t
+{
+    size_t word_index;
+    size_t offset;
+    size_t length;
+    size_t link_length;
+};
+
+
+/* why a limited query returned */
+typedef enum {
+    DEA_QUERY_COMPLETE,           /* the whole input was scanned */
+    DEA_QUERY_MAX_MATCHES,        /* max_matches were reported */
+    DEA_QUERY_MAX_BYTES,          /* max_bytes were scanned */
+    DEA_QUERY_DEADLINE,           /* the deadline passed */
+    DEA_QUERY_CANCELLED           /* cancel was set */
+} dea_query_status_t;
+
+
+/* limits of a single call of a limited query, 0 and nullptr for none. the
+ * deadline and cancel are checked every DEA_QUERY_CHECK_BYTES bytes.
+ */
+struct dea_query_limits_t
+{
+    dea_query_limits_t() :
+        max_matches( 0 ),
+        max_bytes( 0 ),
+        deadline( std::chrono::steady_clock::time_point::max() ),
+        cancel( nullptr )
+    {
+    }
+
+    size_t                                max_matches;
+    size_t                                max_bytes;
+    std::chrono::steady_clock::time_point deadline;
+    const std::atomic<bool>*              cancel;
+};
+
+
+/* where a limited query stopped. passed back with the same input the query
+ * continues there without losing or repeating a match.
+ */
+struct dea_query_cursor_t
+{
+    dea_query_cursor_t() :
+        offset( 0 ),
+        state( 0 ),
+        output( 0 ),
+        status( DEA_QUERY_COMPLETE )
+    {
+    }
+
+    size_t             offset;        /* next byte of the input */
+    uint32_t           state;
+    uint32_t           output;        /* rest of the matches ending at offset */
+    dea_query_status_t status;
+};
+
+
+/* all offsets are relative to the start of the tables, so the tables
+ * can be copied or mapped to any address
+ */
+struct dea_compiled_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint32_t state_count;
+    uint32_t transition_count;
+    uint32_t word_count;
+    uint32_t min_word_length;
+    uint32_t max_word_length;
+    uint32_t encoding;
+    uint32_t dense_count;
+    uint32_t reserved;
+    uint64_t states_offset;
+    uint64_t symbols_offset;
+    uint64_t next_offset;
+    uint64_t word_masks_offset;
+    uint64_t dense_offset;
+};
+
+
+/* the transitions of a state are stored sorted by symbol in the
+ * symbols/next arrays starting at first_transition. with the hybrid
+ * encoding shortcut is the chain length of a single transition state: its
+ * symbol and those of the next shortcut - 1 states lead straight through
+ * states without output. for a larger row it is the dense table + 1, if
+ * it has one. output_link points
+ * to the next accepting state on the failure chain, 0 ends the chain.
+ * output_mask combines the categories of all words accepted here or
+ * along the output chain.
+ */
+struct dea_compiled_state_t
+{
+    uint32_t   first_transition;
+    uint16_t   transition_count;
+    uint16_t   shortcut;
+    uint32_t   fail;
+    int32_t    word_index;
+    uint32_t   output_link;
+    uint32_t   depth;
+    dea_mask_t output_mask;
+};
+
+
+/*******************************************************************************
+ * read-only view on compiled tables. the view does not own the memory.
+ ******************************************************************************/
+class DeaTables
+{
+public:
+    DeaTables() :
+        m_header( nullptr ),
+        m_states( nullptr ),
+        m_symbols( nullptr ),
+        m_next( nullptr ),
+        m_word_masks( nullptr ),
+        m_dense( nullptr ),
+        m_hybrid( false )
+    {
+    }
+
+    explicit DeaTables( const uint8_t* base ) :
+        m_header( reinterpret_cast<const dea_compiled_header_t*>( base ) ),
+        m_states( reinterpret_cast<const dea_compiled_state_t*>( base + m_header->states_offset ) ),
+        m_symbols( base + m_header->symbols_offset ),
+        m_next( reinterpret_cast<const uint32_t*>( base + m_header->next_offset ) ),
+        m_word_masks( reinterpret_cast<const dea_mask_t*>( base + m_header->word_masks_offset ) ),
+        m_dense( reinterpret_cast<const uint32_t*>( base + m_header->dense_offset ) ),
+        m_hybrid( DEA_ENCODING_HYBRID == m_header->encoding )
+    {
+    }
+
+public:
+    /**************************************************************************
+     *
+     **************************************************************************/
+    bool valid() const
+    {
+        return ( nullptr != m_header ) && ( m_header->state_count > 0 );
+    }
+
+    /**************************************************************************
+     *
+     **************************************************************************/
+    const dea_compiled_header_t& header() const
+    {
+        return *m_header;
+    }
+
+    /**************************************************************************
+     * start of the tables, header().size bytes can be copied from here
+     **************************************************************************/
+    const uint8_t* data() const
+    {
+        return reinterpret_cast<const uint8_t*>( m_header );
+    }
+
+    /**************************************************************************
+     *
+     **************************************************************************/
+    const dea_compiled_state_t& state( uint32_t idx ) const
+    {
+        return m_states[idx];
+    }
+
+    /**************************************************************************
+     * symbol and target of transition t_idx of the whole table
+     **************************************************************************/
+    uint8_t transition_symbol( uint32_t t_idx ) const
+    {
+        return m_symbols[t_idx];
+    }
+    uint32_t transition_target( uint32_t t_idx ) const
+    {
+        return m_next[t_idx];
+    }
+
+    /**************************************************************************
+     *
+     **************************************************************************/
+    dea_mask_t word_mask( size_t word_index ) const
+    {
+        return m_word_masks[word_index];
+    }
+
+    /**************************************************************************
+     * the trie transition of s on symbol or DEA_NO_STATE
+     **************************************************************************/
+    uint32_t goto_state( uint32_t s, uint8_t symbol ) const
+    {
+        const dea_compiled_state_t& st = m_states[s];
+        const uint8_t* symbols = m_symbols + st.first_transition;
+        uint32_t count = st.transition_count;
+
+        if ( m_hybrid )
+        {
+            if ( count <= DEA_SPARSE_TRANSITIONS )
+            {
+                return goto_sparse( st, symbol );
+            }
+            if ( 0 != st.shortcut )
+            {
+                return m_dense[( st.shortcut - 1 ) * 256 + symbol];
+            }
+        }
+        else if ( count <= 8 )
+        {
+            for ( uint32_t t_idx = 0; t_idx < count; t_idx++ )
+            {
+                if ( symbols[t_idx] == symbol )
+                    return m_next[st.first_transition + t_idx];
+            }
+            return DEA_NO_STATE;
+        }
+
+        uint32_t low = 0;
+        uint32_t high = count;
+        while ( low < high )
+        {
+            uint32_t mid = ( low + high ) / 2;
+            if ( symbols[mid] < symbol )
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        if ( ( low < count ) && ( symbols[low] == symbol ) )
+            return m_next[st.first_transition + low];
+
+        return DEA_NO_STATE;
+    }
+
+    /**************************************************************************
+     * number of input bytes a walk along the trie can skip at s: the
+     * length of the chain starting at s if input continues with its bytes,
+     * otherwise 0. the state after them is chain_end( s ).
+     **************************************************************************/
+    uint32_t match_chain( uint32_t s, const uint8_t* input, size_t len ) const
+    {
+        const dea_compiled_state_t& st = m_states[s];
+        if ( !m_hybrid || ( 1 != st.transition_count ) || ( st.shortcut < 2 ) || ( st.shortcut > len ) )
+            return 0;
+        return ( 0 == memcmp( input, m_symbols + st.first_transition, st.shortcut ) ) ? st.shortcut : 0;
+    }
+
+    uint32_t chain_end( uint32_t s ) const
+    {
+        return m_next[m_states[s].first_transition + m_states[s].shortcut - 1];
+    }
+
+    /**************************************************************************
+     * how the rows of the tables are searched
+     **************************************************************************/
+    dea_encoding_stats_t encoding_stats() const;
+
+    /**************************************************************************
+     * one step of the dea: follow the trie or the failure links
+     **************************************************************************/
+    uint32_t next_state( uint32_t s, uint8_t symbol ) const
+    {
+        for (;;)
+        {
+            uint32_t t = goto_state( s, symbol );
+            if ( DEA_NO_STATE != t )
+                return t;
+            if ( 0 == s )
+                return 0;
+            s = m_states[s].fail;
+        }
+    }
+
+    /**************************************************************************
+     * index of word if it is part of the dictionary or -1
+     **************************************************************************/
+    ssize_t lookup( const uint8_t* word, size_t len ) const
+    {
+        uint32_t s = 0;
+        for ( size_t input_idx = 0; input_idx < len; input_idx++ )
+        {
+            uint32_t skip = match_chain( s, word + input_idx, len - input_idx );
+            if ( 0 != skip )
+            {
+                s = chain_end( s );
+                input_idx += skip - 1;
+                continue;
+            }
+            s = goto_state( s, word[input_idx] );
+            if ( DEA_NO_STATE == s )
+                return -1;
+        }
+        return m_states[s].word_index;
+    }
+
+    /**************************************************************************
+     * counts every state whose transitions are looked at while scanning
+     * input. visits is indexed by order[state].
+     **************************************************************************/
+    void count_visits( const uint8_t* input, size_t len, const uint32_t* order, uint64_t* visits ) const
+    {
+        uint32_t s = 0;
+        for ( size_t input_idx = 0; input_idx < len; input_idx++ )
+        {
+            for (;;)
+            {
+                visits[order[s]]++;
+                uint32_t t = goto_state( s, input[input_idx] );
+                if ( DEA_NO_STATE != t )
+                {
+                    s = t;
+                    break;
+                }
+                if ( 0 == s )
+                    break;
+                s = m_states[s].fail;
+            }
+        }
+    }
+
+    /**************************************************************************
+     * appends the index of every word of the given categories ending at
+     * state s to result
+     **************************************************************************/
+    void collect_outputs( uint32_t s, dea_mask_t mask, std::vector<ssize_t>& result ) const
+    {
+        uint32_t o = ( m_states[s].word_index >= 0 ) ? s : m_states[s].output_link;
+        while ( 0 != o )
+        {
+            size_t word_index = static_cast<size_t>( m_states[o].word_index );
+            if ( 0 != ( m_word_masks[word_index] & mask ) )
+                result.push_back( static_cast<ssize_t>( word_index ) );
+            o = m_states[o].output_link;
+        }
+    }
+
+    /**************************************************************************
+     * indices of all words of the given categories contained in input,
+     * a word is reported once per occurrence
+     **************************************************************************/
+    void find_all( const uint8_t* input, size_t len, dea_mask_t mask, std::vector<ssize_t>& result ) const
+    {
+        uint32_t s = 0;
+        for ( size_t input_idx = 0; input_idx < len; input_idx++ )
+        {
+            s = next_state( s, input[input_idx] );
+            if ( 0 != ( m_states[s].output_mask & mask ) )
+            {
+                collect_outputs( s, mask, result );
+            }
+        }
+    }
+
+    /**************************************************************************
+     * same matches as find_all, possibly in another order. input is split
+     * into lanes that are scanned in lockstep, each lane starts
+     * max_word_length - 1 bytes early so no word crossing a lane border is
+     * lost. the lookups of one lane hide the memory latency of the others.
+     **************************************************************************/
+    void find_all_interleaved( const uint8_t* input, size_t len, dea_mask_t mask,
+                               size_t lanes, std::vector<ssize_t>& result ) const;
+
+    /**************************************************************************
+     * find_all from cursor on within limits. the matches of this call are
+     * appended to result, cursor tells where and why it stopped.
+     **************************************************************************/
+    void find_all_limited( const uint8_t* input, size_t len, dea_mask_t mask,
+                           const dea_query_limits_t& limits,
+                           dea_query_cursor_t& cursor,
+                           std::vector<ssize_t>& result ) const;
+
+    /**************************************************************************
+     * index of the leftmost word of the given categories contained in input
+     * (the shortest one if several start at the same position) or -1. the
+     * start of a word is its end minus the depth of its state, the scan
+     * stops once no later word can start before the best one.
+     **************************************************************************/
+    ssize_t find_first( const uint8_t* input, size_t len, dea_mask_t mask ) const
+    {
+        ssize_t result     = -1;
+        size_t  best_start = len;
+        size_t  max_length = m_header->max_word_length;
+        uint32_t s = 0;
+        for ( size_t input_idx = 0; ( input_idx < len ) && ( input_idx + 1 < best_start + max_length ); input_idx++ )
+        {
+            s = next_state( s, input[input_idx] );
+            if ( 0 != ( m_states[s].output_mask & mask ) )
+            {
+                uint32_t o = ( m_states[s].word_index >= 0 ) ? s : m_states[s].output_link;
+                while ( 0 != o )
+                {
+                    size_t start = input_idx + 1 - m_states[o].depth;
+                    if ( ( start < best_start ) && ( 0 != ( m_word_masks[m_states[o].word_index] & mask ) ) )
+                    {
+                        result     = m_states[o].word_index;
+                        best_start = start;
+                    }
+                    o = m_states[o].output_link;
+                }
+            }
+        }
+        return result;
+    }
+
+    /**************************************************************************
+     * indices of the words of the given categories that are prefixes of
+     * input, shortest first. with reverse set input is read backwards from
+     * its end, so tables built from reversed words yield its suffixes.
+     * follows only trie transitions and stops where the trie ends or, with
+     * first_only, at the first word.
+     **************************************************************************/
+    void find_prefixes( const uint8_t* input, size_t len, bool reverse, dea_mask_t mask,
+                        bool first_only, std::vector<ssize_t>& result ) const
+    {
+        uint32_t s = 0;
+        for ( size_t input_idx = 0; input_idx < len; input_idx++ )
+        {
+            uint32_t skip = reverse ? 0 : match_chain( s, input + input_idx, len - input_idx );
+            if ( 0 != skip )
+            {
+                s = chain_end( s );
+                input_idx += skip - 1;
+            }
+            else
+            {
+                s = goto_state( s, input[reverse ? ( len - 1 - input_idx ) : input_idx] );
+                if ( DEA_NO_STATE == s )
+                    return;
+            }
+
+            int32_t word_index = m_states[s].word_index;
+            if ( ( word_index >= 0 ) && ( 0 != ( m_word_masks[word_index] & mask ) ) )
+            {
+                result.push_back( word_index );
+                if ( first_only )
+                    return;
+            }
+        }
+    }
+
+    /**************************************************************************
+     * true if input contains a word of the given categories, stops at the
+     * first state with such an output
+     **************************************************************************/
+    bool contains_any( const uint8_t* input, size_t len, dea_mask_t mask ) const
+    {
+        uint32_t s = 0;
+        for ( size_t input_idx = 0; input_idx < len; input_idx++ )
+        {
+            s = next_state( s, input[input_idx] );
+            if ( 0 != ( m_states[s].output_mask & mask ) )
+                return true;
+        }
+        return false;
+    }
+
+    /**************************************************************************
+     * combined categories of all words contained in input restricted to
+     * mask, stops once every requested category was seen
+     **************************************************************************/
+    dea_mask_t find_categories( const uint8_t* input, size_t len, dea_mask_t mask ) const
+    {
+        dea_mask_t result = 0;
+        uint32_t s = 0;
+        for ( size_t input_idx = 0; ( input_idx < len ) && ( 0 != mask ); input_idx++ )
+        {
+            s = next_state( s, input[input_idx] );
+            dea_mask_t found = m_states[s].output_mask & mask;
+            result |= found;
+            mask   &= ~found;
+        }
+        return result;
+    }
+
+    /**************************************************************************
+     * splits word completely into words of the given categories, linking
+     * elements are only allowed between two parts. false if there is no
+     * such split.
+     **************************************************************************/
+    bool segment( const uint8_t* word, size_t len, dea_mask_t mask,
+                  dea_segment_mode_t mode,
+                  const std::vector<std::string>& linking,
+                  std::vector<dea_segment_t>& result ) const;
+
+private:
+    /**************************************************************************
+     * the key bytes of a row are followed by at least DEA_SPARSE_TRANSITIONS
+     * readable bytes, so a row is compared with one unaligned load
+     **************************************************************************/
+    uint32_t goto_sparse( const dea_compiled_state_t& st, uint8_t symbol ) const
+    {
+        const uint8_t* symbols = m_symbols + st.first_transition;
+        uint32_t count = st.transition_count;
+
+        if ( 1 == count )
+        {
+            return ( symbols[0] == symbol ) ? m_next[st.first_transition] : DEA_NO_STATE;
+        }
+#if defined( __SSE2__ )
+        __m128i  keys = _mm_loadu_si128( reinterpret_cast<const __m128i*>( symbols ) );
+        uint32_t hits = static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( keys, _mm_set1_epi8( static_cast<char>( symbol ) ) ) ) );
+        hits &= ( 1u << count ) - 1;
+        return ( 0 != hits ) ? m_next[st.first_transition + __builtin_ctz( hits )] : DEA_NO_STATE;
+#else
+        for ( uint32_t t_idx = 0; t_idx < count; t_idx++ )
+        {
+            if ( symbols[t_idx] == symbol )
+                return m_next[st.first_transition + t_idx];
+        }
+        return DEA_NO_STATE;
+#endif
+    }
+
+private:
+    const dea_compiled_header_t* m_header;
+    const dea_compiled_state_t*  m_states;
+    const uint8_t*               m_symbols;
+    const uint32_t*              m_next;
+    const dea_mask_t*            m_word_masks;
+    const uint32_t*              m_dense;
+    bool                         m_hybrid;
+};
+
+
+/*******************************************************************************
+ * owns the compiled tables and their replicas
+ ******************************************************************************/
+class DeaCompiled
+{
+public:
+    DeaCompiled();
+    ~DeaCompiled() {}
+
+    /**************************************
+     * builds the tables from the trie of
+     * builder, keeping its state
+     * numbering
+     *************************************/
+    void compile( const DeaBuilder& builder, size_t word_count );
+
+    /**************************************
+     * builds the tables straight from a
+     * word list on several threads. words
+     * listed more than once are removed
+     * from words and masks, keeping the
+     * first one with the combined mask.
+     *************************************/
+    void compile_parallel( std::vector<std::string>& words,
+                           std::vector<dea_mask_t>& masks,
+                           size_t threads );
+
+    /**************************************
+     * releases the tables and replicas
+     *************************************/
+    void clear();
+
+    /**************************************
+     * adds a transition on the upper case
+     * byte next to every lower case one,
+     * so words compiled in lower case
+     * match in any case. applies to later
+     * compiles.
+     *************************************/
+    void set_case_folding( dea_case_fold_t fold );
+    dea_case_fold_t case_folding() const;
+
+    /**************************************
+     * moves the tables to memory with the
+     * given page mode and optionally puts
+     * a read-only replica on every numa
+     * node
+     *************************************/
+    void set_placement( table_page_mode_t pages, bool numa_replicate );
+
+    /**************************************
+     * renumbers the states of the tables.
+     * visits is indexed by insertion order
+     * and only used for DEA_LAYOUT_PROFILE.
+     * also applies to later compiles.
+     *************************************/
+    void set_layout( dea_layout_t layout,
+                     const std::vector<uint64_t>& visits=std::vector<uint64_t>() );
+
+    /**************************************
+     * how goto_state searches the rows,
+     * hybrid by default. also applies to
+     * later compiles.
+     *************************************/
+    void set_encoding( dea_encoding_t encoding );
+    dea_encoding_t encoding() const;
+
+    /**************************************
+     * adds the state visits of scanning
+     * input to visits, indexed by
+     * insertion order
+     *************************************/
+    void record_visits( const uint8_t* input, size_t len, std::vector<uint64_t>& visits ) const;
+
+    /**************************************
+     * tables local to the numa node of
+     * the calling thread
+     *************************************/
+    DeaTables tables() const;
+
+    /**************************************
+     *
+     *************************************/
+    size_t table_size() const;
+    table_page_mode_t pages() const;
+    size_t replica_count() const;
+    dea_layout_t layout() const;
+
+private:
+    /**************************************
+     *
+     *************************************/
+    static dea_compiled_header_t make_header( size_t state_count,
+                                              size_t transition_count,
+                                              size_t word_count );
+
+    /**************************************
+     *
+     *************************************/
+    void link_states();
+    void finish();
+
+    /**************************************
+     *
+     *************************************/
+    void add_case_folding();
+
+    /**************************************
+     *
+     *************************************/
+    void relayout();
+
+    /**************************************
+     * order[i] is the current state that
+     * becomes state i
+     *************************************/
+    void permute( const std::vector<uint32_t>& order );
+
+    /**************************************
+     * chains and dense tables of the
+     * final state order
+     *************************************/
+    void encode();
+
+    /**************************************
+     *
+     *************************************/
+    void place( TableMemory& source );
+
+private:
+    TableMemory              m_tables;
+    std::vector<TableMemory> m_replicas;
+    table_page_mode_t        m_pages;
+    bool                     m_numa_replicate;
+    dea_layout_t             m_layout;
+    dea_encoding_t           m_encoding;
+    dea_case_fold_t          m_case_fold;
+    std::vector<uint64_t>    m_visits;
+    std::vector<uint32_t>    m_order;
+};
+
+}
+
+#endif /* _DEA_COMPILED_H_ */
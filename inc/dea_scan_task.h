@@ -0,0 +1,149 @@
+/*!*****************************************************************************
+ * @file dea_scan_task.h
+ * @brief c++20 coroutine driving a DeaScanner in time slices
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _DEA_SCAN_TASK_H_
+#define _DEA_SCAN_TASK_H_
+
+#include "dea_scanner.h"
+
+/* the library itself is built as c++17, only users compiling with
+ * coroutine support get the task
+ */
+#if defined( __cpp_impl_coroutine )
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace fastdict
+{
+
+
+/**************************************
+ * coroutine that suspends after every
+ * slice. an event loop calls step()
+ * once per turn and drains the sink
+ * while step() reports
+ * DEA_SCAN_SINK_FULL.
+ *************************************/
+class DeaScanTask
+{
+public:
+    struct promise_type
+    {
+        dea_scan_status_t status = DEA_SCAN_BUDGET;
+
+        DeaScanTask get_return_object()
+        {
+            return DeaScanTask( std::coroutine_handle<promise_type>::from_promise( *this ) );
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value( dea_scan_status_t s ) noexcept
+        {
+            status = s;
+            return {};
+        }
+        void return_void() noexcept { status = DEA_SCAN_DONE; }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    DeaScanTask( DeaScanTask&& other ) noexcept :
+        m_handle( std::exchange( other.m_handle, nullptr ) )
+    {
+    }
+
+    DeaScanTask& operator=( DeaScanTask&& other ) noexcept
+    {
+        if ( this != &other )
+        {
+            if ( m_handle )
+                m_handle.destroy();
+            m_handle = std::exchange( other.m_handle, nullptr );
+        }
+        return *this;
+    }
+
+    DeaScanTask( const DeaScanTask& ) = delete;
+    DeaScanTask& operator=( const DeaScanTask& ) = delete;
+
+    ~DeaScanTask()
+    {
+        if ( m_handle )
+            m_handle.destroy();
+    }
+
+    /**************************************
+     * runs the next slice and returns why
+     * it stopped, DEA_SCAN_DONE at the end
+     *************************************/
+    dea_scan_status_t step()
+    {
+        if ( !m_handle.done() )
+            m_handle.resume();
+        return m_handle.promise().status;
+    }
+
+    /**************************************
+     *
+     *************************************/
+    bool done() const { return m_handle.done(); }
+
+private:
+    explicit DeaScanTask( std::coroutine_handle<promise_type> handle ) :
+        m_handle( handle )
+    {
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+
+/**************************************
+ * feeds data to scanner and scans it
+ * in slices of slice_bytes, suspending
+ * after each slice and while sink is
+ * full. data must stay valid until the
+ * task is done.
+ *************************************/
+inline DeaScanTask scan_in_slices( DeaScanner& scanner,
+                                   const uint8_t* data,
+                                   size_t len,
+                                   DeaMatchSink& sink,
+                                   size_t slice_bytes )
+{
+    scanner.feed( data, len );
+    for (;;)
+    {
+        dea_scan_status_t status = scanner.resume( slice_bytes, sink );
+        if ( DEA_SCAN_DONE == status )
+            co_return;
+        co_yield status;
+    }
+}
+
+}
+
+#endif /* __cpp_impl_coroutine */
+
+#endif /* _DEA_SCAN_TASK_H_ */
@@ -0,0 +1,141 @@
+/*!*****************************************************************************
+ * @file dea_scanner.h
+ * @brief resumable scan of a stream on the compiled dea
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _DEA_SCANNER_H_
+#define _DEA_SCANNER_H_
+
+#include "dea_compiled.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace fastdict
+{
+
+
+/* why DeaScanner::resume returned */
+typedef enum {
+    DEA_SCAN_DONE,            /* the fed data is consumed, feed more */
+    DEA_SCAN_BUDGET,          /* max_bytes were scanned */
+    DEA_SCAN_SINK_FULL        /* drain the sink, then resume */
+} dea_scan_status_t;
+
+
+/* word_index ends right before the stream offset end */
+struct dea_match_t
+{
+    size_t word_index;
+    size_t end;
+};
+
+
+/**************************************
+ * fixed size queue of matches between
+ * a scanner and its consumer
+ *************************************/
+class DeaMatchSink
+{
+public:
+    explicit DeaMatchSink( size_t capacity );
+
+    /**************************************
+     * false if the sink is full
+     *************************************/
+    bool push( const dea_match_t& match );
+
+    /**************************************
+     * false if the sink is empty
+     *************************************/
+    bool pop( dea_match_t& match );
+
+    /**************************************
+     *
+     *************************************/
+    bool full() const { return m_count == m_buffer.size(); }
+    bool empty() const { return 0 == m_count; }
+    size_t size() const { return m_count; }
+    size_t capacity() const { return m_buffer.size(); }
+
+private:
+    std::vector<dea_match_t> m_buffer;
+    size_t                   m_head;
+    size_t                   m_count;
+};
+
+
+/**************************************
+ * scans a stream fed in chunks in
+ * slices of a bounded number of bytes.
+ * words crossing chunk borders are
+ * found. the tables must outlive the
+ * scanner, a fed chunk must stay valid
+ * until resume returns DEA_SCAN_DONE.
+ *************************************/
+class DeaScanner
+{
+public:
+    explicit DeaScanner( const DeaTables& tables, dea_mask_t mask=DEA_ALL_CATEGORIES );
+
+    /**************************************
+     * starts a new stream
+     *************************************/
+    void reset();
+
+    /**************************************
+     * the next chunk of the stream
+     *************************************/
+    void feed( const uint8_t* data, size_t len );
+
+    /**************************************
+     * scans at most max_bytes of the fed
+     * chunk and pushes the matches into
+     * sink. stops as soon as sink is
+     * full, no match is lost.
+     *************************************/
+    dea_scan_status_t resume( size_t max_bytes, DeaMatchSink& sink );
+
+    /**************************************
+     * stream offset of the next byte
+     *************************************/
+    size_t position() const { return m_position; }
+
+private:
+    /**************************************
+     * pushes the rest of the output chain
+     * at m_output
+     *************************************/
+    bool flush( DeaMatchSink& sink );
+
+private:
+    DeaTables      m_tables;
+    dea_mask_t     m_mask;
+    uint32_t       m_state;
+    uint32_t       m_output;
+    size_t         m_position;
+    const uint8_t* m_data;
+    size_t         m_length;
+    size_t         m_offset;
+};
+
+}
+
+#endif /* _DEA_SCANNER_H_ */
@@ -24,8 +24,16 @@
 #define _FASTDICT_H_
 
 #include "dea.h"
+#include "dea_builder.h"
+#include "dea_compiled.h"
+#include "dea_scanner.h"
+#include "louds_trie.h"
+#include "qgram_filter.h"
+#include "shared_dict.h"
 
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <algorithm>
 #include <sstream>
@@ -40,14 +48,33 @@ namespace fastdict
 class FastDict
 {
 public:
+    /* eToLower and eToUpper convert the ascii letters of the words.
+     * eFoldCase lower cases the utf-8 encoded latin letters of the words
+     * and lets the automaton match them in any case, see case_fold.h.
+     */
     typedef enum {
         eToLower,
         eToUpper,
         eNone,
+        eFoldCase,
     } EConvertChars;
 
+    /* eAutomaton compiles the words into the tables all queries run on.
+     * eSuccinct keeps them in a louds trie with about 1.4 bytes per trie
+     * node instead of the automaton and the word list. its queries are
+     * several times slower and only know the default category, the
+     * limited, anchored, segment and scanner queries are rejected.
+     * eShared queries the tables another process published with
+     * publish_shared, see attach_shared.
+     */
+    typedef enum {
+        eAutomaton,
+        eSuccinct,
+        eShared,
+    } EBackend;
+
 
-    FastDict( const std::string input_list_name="", EConvertChars conv=eNone );
+    FastDict( const std::string& input_list_name="", EConvertChars conv=eNone );
     virtual ~FastDict() {}
 
     /**************************************
@@ -62,38 +89,479 @@ public:
 
 
     /**************************************
-     *
+     * prints the states and transitions
+     * of the compiled tables
      *************************************/
     void print_dea();
 
     /**************************************
      *
      *************************************/
-    void load_from_list( const std::string input_list_name, EConvertChars conv=eNone );
+    void load_from_list( const std::string& input_list_name,
+                         EConvertChars conv=eNone,
+                         EBackend backend=eAutomaton );
+
+    /**************************************
+     * builds the dictionary from words
+     * already in memory. the strings of
+     * the moved vector become the word
+     * list without a copy.
+     *************************************/
+    void load_words( std::vector<std::string>&& words,
+                     EConvertChars conv=eNone,
+                     EBackend backend=eAutomaton );
+
+    /**************************************
+     * copies every word of [first, last)
+     * once, anything a std::string can be
+     * constructed from
+     *************************************/
+    template <typename Iterator>
+    void load_words( Iterator first,
+                     Iterator last,
+                     EConvertChars conv=eNone,
+                     EBackend backend=eAutomaton )
+    {
+        std::vector<std::string> words;
+        for ( ; first != last; ++first )
+        {
+            words.emplace_back( *first );
+        }
+        load_words( std::move( words ), conv, backend );
+    }
+
+    /**************************************
+     *
+     *************************************/
+    EBackend backend() const;
+
+    /**************************************
+     * adds the words of another list to
+     * the same dea, tagged with the given
+     * category bitmask
+     *************************************/
+    void add_list( const std::string& input_list_name,
+                   dea_mask_t categories,
+                   EConvertChars conv=eNone );
+
+    /**************************************
+     * like add_list for words in memory
+     *************************************/
+    void add_words( std::vector<std::string>&& words,
+                    dea_mask_t categories,
+                    EConvertChars conv=eNone );
+
+    /* the queries take a std::string_view, or a buffer and its length.
+     * char pointers get the buffer overloads, so ( buffer, length ) is not
+     * read as a string and a category mask. char arrays like string
+     * literals keep the std::string_view overloads, so ( "words", mask )
+     * still passes a mask.
+     */
+    template <typename T>
+    static constexpr bool is_char_pointer = std::is_same_v<std::remove_cv_t<std::remove_reference_t<T>>, const char*>
+                                         || std::is_same_v<std::remove_cv_t<std::remove_reference_t<T>>, char*>;
+
+    /**************************************
+     *
+     *************************************/
+    std::vector<std::string> get_contained_words( std::string_view sequence,
+                                                  dea_mask_t categories=DEA_ALL_CATEGORIES );
+    std::vector<std::string> get_contained_words( const uint8_t* data,
+                                                  size_t length,
+                                                  dea_mask_t categories=DEA_ALL_CATEGORIES );
+    template <typename Pointer, typename = std::enable_if_t<is_char_pointer<Pointer>>>
+    std::vector<std::string> get_contained_words( Pointer&& data,
+                                                  size_t length,
+                                                  dea_mask_t categories=DEA_ALL_CATEGORIES )
+    {
+        return get_contained_words( reinterpret_cast<const uint8_t*>( data ), length, categories );
+    }
+
+    /**************************************
+     * get_contained_words within limits,
+     * starting at cursor. words are
+     * reported once per occurrence in the
+     * order they end. call again with
+     * the same sequence and cursor until
+     * its status is DEA_QUERY_COMPLETE to
+     * get the remaining words. not
+     * supported by the succinct backend.
+     *************************************/
+    std::vector<std::string> get_contained_words( std::string_view sequence,
+                                                  const dea_query_limits_t& limits,
+                                                  dea_query_cursor_t& cursor,
+                                                  dea_mask_t categories=DEA_ALL_CATEGORIES );
+    std::vector<std::string> get_contained_words( const uint8_t* data,
+                                                  size_t length,
+                                                  const dea_query_limits_t& limits,
+                                                  dea_query_cursor_t& cursor,
+                                                  dea_mask_t categories=DEA_ALL_CATEGORIES );
+    template <typename Pointer, typename = std::enable_if_t<is_char_pointer<Pointer>>>
+    std::vector<std::string> get_contained_words( Pointer&& data,
+                                                  size_t length,
+                                                  const dea_query_limits_t& limits,
+                                                  dea_query_cursor_t& cursor,
+                                                  dea_mask_t categories=DEA_ALL_CATEGORIES )
+    {
+        return get_contained_words( reinterpret_cast<const uint8_t*>( data ), length, limits, cursor, categories );
+    }
+
+    /**************************************
+     * true if sequence contains at least
+     * one word of the dictionary
+     *************************************/
+    bool contains_any( std::string_view sequence,
+                       dea_mask_t categories=DEA_ALL_CATEGORIES );
+    bool contains_any( const uint8_t* data,
+                       size_t length,
+                       dea_mask_t categories=DEA_ALL_CATEGORIES );
+    template <typename Pointer, typename = std::enable_if_t<is_char_pointer<Pointer>>>
+    bool contains_any( Pointer&& data,
+                       size_t length,
+                       dea_mask_t categories=DEA_ALL_CATEGORIES )
+    {
+        return contains_any( reinterpret_cast<const uint8_t*>( data ), length, categories );
+    }
+
+    /**************************************
+     * leftmost word contained in sequence
+     * (the shortest one if several start
+     * at the same position) or an empty
+     * string
+     *************************************/
+    std::string first_match( std::string_view sequence,
+                             dea_mask_t categories=DEA_ALL_CATEGORIES );
+    std::string first_match( const uint8_t* data,
+                             size_t length,
+                             dea_mask_t categories=DEA_ALL_CATEGORIES );
+    template <typename Pointer, typename = std::enable_if_t<is_char_pointer<Pointer>>>
+    std::string first_match( Pointer&& data,
+                             size_t length,
+                             dea_mask_t categories=DEA_ALL_CATEGORIES )
+    {
+        return first_match( reinterpret_cast<const uint8_t*>( data ), length, categories );
+    }
+
+    /**************************************
+     * true if word is part of the
+     * dictionary
+     *************************************/
+    bool contains_word( std::string_view word );
+
+    /**************************************
+     * combined categories of all words
+     * contained in sequence
+     *************************************/
+    dea_mask_t get_contained_categories( std::string_view sequence,
+                                         dea_mask_t categories=DEA_ALL_CATEGORIES );
+    dea_mask_t get_contained_categories( const uint8_t* data,
+                                         size_t length,
+                                         dea_mask_t categories=DEA_ALL_CATEGORIES );
+    template <typename Pointer, typename = std::enable_if_t<is_char_pointer<Pointer>>>
+    dea_mask_t get_contained_categories( Pointer&& data,
+                                         size_t length,
+                                         dea_mask_t categories=DEA_ALL_CATEGORIES )
+    {
+        return get_contained_categories( reinterpret_cast<const uint8_t*>( data ), length, categories );
+    }
+
+    /**************************************
+     * words found at the start, at the
+     * end or as the whole of sequence.
+     * DEA_ANCHOR_SUFFIX reads sequence
+     * backwards once if the reverse
+     * automaton is enabled and otherwise
+     * looks up every suffix up to the
+     * longest word.
+     *************************************/
+    std::vector<std::string> get_anchored_words( std::string_view sequence,
+                                                 dea_anchor_t anchor,
+                                                 dea_mask_t categories=DEA_ALL_CATEGORIES );
+    std::vector<std::string> get_anchored_words( const uint8_t* data,
+                                                 size_t length,
+                                                 dea_anchor_t anchor,
+                                                 dea_mask_t categories=DEA_ALL_CATEGORIES );
+    template <typename Pointer, typename = std::enable_if_t<is_char_pointer<Pointer>>>
+    std::vector<std::string> get_anchored_words( Pointer&& data,
+                                                 size_t length,
+                                                 dea_anchor_t anchor,
+                                                 dea_mask_t categories=DEA_ALL_CATEGORIES )
+    {
+        return get_anchored_words( reinterpret_cast<const uint8_t*>( data ), length, anchor, categories );
+    }
+
+    /**************************************
+     * like get_anchored_words but stops
+     * at the first word
+     *************************************/
+    bool contains_anchored( std::string_view sequence,
+                            dea_anchor_t anchor,
+                            dea_mask_t categories=DEA_ALL_CATEGORIES );
+    bool contains_anchored( const uint8_t* data,
+                            size_t length,
+                            dea_anchor_t anchor,
+                            dea_mask_t categories=DEA_ALL_CATEGORIES );
+    template <typename Pointer, typename = std::enable_if_t<is_char_pointer<Pointer>>>
+    bool contains_anchored( Pointer&& data,
+                            size_t length,
+                            dea_anchor_t anchor,
+                            dea_mask_t categories=DEA_ALL_CATEGORIES )
+    {
+        return contains_anchored( reinterpret_cast<const uint8_t*>( data ), length, anchor, categories );
+    }
+
+    /**************************************
+     * resumable scanner on the current
+     * tables, it must not be used after
+     * the next load. resolve the matches
+     * with word_at.
+     *************************************/
+    DeaScanner make_scanner( dea_mask_t categories=DEA_ALL_CATEGORIES );
+
+    /**************************************
+     * builds a second automaton from the
+     * reversed words for suffix queries,
+     * now and for lists loaded later on.
+     * eFoldCase dictionaries keep the
+     * forward suffix lookups.
+     *************************************/
+    void set_reverse_automaton( bool enabled );
+
+    /**************************************
+     * splits a compound word into words
+     * of the dictionary in one scan, see
+     * dea_segment_mode_t. linking holds
+     * elements like "s" or "n" allowed
+     * between two parts. the parts refer
+     * to word_at and to offsets in word.
+     *************************************/
+    bool segment_word( std::string_view word,
+                       std::vector<dea_segment_t>& parts,
+                       dea_segment_mode_t mode=DEA_SEGMENT_FEWEST_PARTS,
+                       const std::vector<std::string>& linking=std::vector<std::string>(),
+                       dea_mask_t categories=DEA_ALL_CATEGORIES );
+
+    /**************************************
+     *
+     *************************************/
+    std::string word_at( size_t index ) const;
+
+    /**************************************
+     *
+     *************************************/
+    size_t min_word_length() const;
+
+    /**************************************
+     * moves the compiled tables to huge
+     * pages and/or replicates them on
+     * every numa node. also applies to
+     * lists loaded later on.
+     *************************************/
+    void set_table_placement( table_page_mode_t pages, bool numa_replicate=false );
+
+    /**************************************
+     *
+     *************************************/
+    size_t table_size() const;
+
+    /**************************************
+     * threads used to build the tables of
+     * lists loaded later on, 0 for one per
+     * cpu. more than one thread builds the
+     * tables straight from the word list
+     * (also for lists added to it), state
+     * profiles only fit the tables built
+     * the same way.
+     *************************************/
+    void set_build_threads( size_t threads );
+
+    /**************************************
+     * splits long sequences into lanes
+     * scanned in lockstep by
+     * get_contained_words, 1 (default)
+     * scans sequentially
+     *************************************/
+    void set_scan_lanes( size_t lanes );
+
+    /**************************************
+     * q > 0 builds a bitmap of the first
+     * q bytes of all words, now and for
+     * lists loaded later on. the queries
+     * on sequences then skip the automaton
+     * for sequences without any of them.
+     *************************************/
+    void set_prefilter( size_t q );
+    const QGramFilter& prefilter() const;
+
+    /**************************************
+     * order of the states in the compiled
+     * tables, insertion order by default
+     *************************************/
+    void set_state_layout( dea_layout_t layout );
+
+    /**************************************
+     * how the rows of the compiled tables
+     * are searched, hybrid by default
+     *************************************/
+    void set_state_encoding( dea_encoding_t encoding );
+
+    /**************************************
+     * states of the tables by the way
+     * their row is searched
+     *************************************/
+    dea_encoding_stats_t encoding_stats() const;
+
+    /**************************************
+     * adds the state visits of scanning
+     * sequence to visits, used to train
+     * a DEA_LAYOUT_PROFILE layout
+     *************************************/
+    void record_state_visits( std::string_view sequence, std::vector<uint64_t>& visits );
 
     /**************************************
      *
      *************************************/
-    std::vector<std::string> get_contained_words( const std::string sequence );
+    bool save_state_profile( const std::string& filename, const std::vector<uint64_t>& visits );
+
+    /**************************************
+     * loads visits written by
+     * save_state_profile and switches to
+     * the DEA_LAYOUT_PROFILE layout
+     *************************************/
+    bool load_state_profile( const std::string& filename );
+
+    /**************************************
+     * copies the compiled tables and the
+     * words to shared memory under name
+     * and returns the new generation or 0
+     * on error. processes attached to
+     * name pick it up on refresh_shared.
+     *************************************/
+    uint64_t publish_shared( const std::string& name );
+
+    /**************************************
+     * drops the loaded list and queries
+     * the dictionary published under name
+     * read-only. the word list conversion
+     * operator then returns an empty list.
+     *************************************/
+    bool attach_shared( const std::string& name );
+
+    /**************************************
+     * switches to the newest published
+     * generation, true if it changed.
+     * must not run concurrently with
+     * queries on this object.
+     *************************************/
+    bool refresh_shared();
 
 private:
     /**************************************
      *
      *************************************/
-    void load_list_from_file( const std::string list_name, 
+    DeaTables tables() const;
+
+    /**************************************
+     *
+     *************************************/
+    void load_list_from_file( const std::string& list_name, 
                               std::vector<std::string>& list,
-                              EConvertChars conv=eNone  );
+                              EConvertChars conv=eNone,
+                              dea_mask_t categories=DEA_DEFAULT_CATEGORY );
+
+    /**************************************
+     * resets everything but the settings
+     * before a new list is loaded
+     *************************************/
+    void start_load( EConvertChars conv, EBackend backend );
+
+    /**************************************
+     * true if word is new and has to be
+     * added to the word list at index
+     *************************************/
+    bool insert_word( std::string_view word, size_t index, dea_mask_t categories );
+
+    /**************************************
+     *
+     *************************************/
+    void insert_moved_words( std::vector<std::string>& words,
+                             EConvertChars conv,
+                             dea_mask_t categories );
+
+    /**************************************
+     * the builder is released after every
+     * compile, words added later start
+     * over from the compiled words
+     *************************************/
+    void reopen_builder();
+
+    /**************************************
+     *
+     *************************************/
+    void compile_tables();
+    void compile_reverse();
+    void build_prefilter();
+
+    /**************************************
+     * the louds trie has no case variant
+     * transitions, a succinct dictionary
+     * loaded with eFoldCase is queried
+     * with a folded copy of data
+     *************************************/
+    const uint8_t* succinct_input( const uint8_t* data, size_t length, std::string& folded ) const;
+
+    /**************************************
+     *
+     *************************************/
+    bool prefilter_rejects( const uint8_t* data, size_t length ) const
+    {
+        return ( eAutomaton == m_backend ) && !m_prefilter.may_match( data, length );
+    }
+
+    /**************************************
+     *
+     *************************************/
+    void find_anchored( const uint8_t* data,
+                        size_t length,
+                        dea_anchor_t anchor,
+                        dea_mask_t categories,
+                        bool first_only,
+                        std::vector<ssize_t>& result );
+
+    /**************************************
+     *
+     *************************************/
+    static void convert_chars( uint8_t* data, size_t length, EConvertChars conv );
+
+    /**************************************
+     *
+     *************************************/
+    void load_succinct_from_file( const std::string& list_name,
+                                  EConvertChars conv );
 
     /**************************************
      *
      *************************************/
-    std::vector<uint8_t> get_file_buf( const std::string filename );
+    std::vector<uint8_t> get_file_buf( const std::string& filename );
 private:
     std::vector<std::string> m_words;
     std::string              m_list_fname;
     EConvertChars            m_conv;
+    size_t                   m_min_word_length;
+    size_t                   m_build_threads;
+    bool                     m_parallel_build;
+    size_t                   m_scan_lanes;
+    size_t                   m_prefilter_q;
+    QGramFilter              m_prefilter;
+    std::vector<dea_mask_t>  m_word_masks;
 
-    DeaImproved              m_contains_dea;
+    DeaBuilder               m_builder;
+    DeaCompiled              m_compiled;
+    bool                     m_reverse_enabled;
+    DeaCompiled              m_reverse;
+    EBackend                 m_backend;
+    LoudsTrie                m_succinct;
+    SharedDict               m_shared;
 };
 
 
@@ -0,0 +1,178 @@
+/*!*****************************************************************************
+ * @file louds_trie.h
+ * @brief succinct read-only trie for very large word lists
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _LOUDS_TRIE_H_
+#define _LOUDS_TRIE_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+
+namespace fastdict
+{
+
+
+/**************************************
+ * bit vector with rank and sampled
+ * select directories
+ *************************************/
+class SuccinctBits
+{
+public:
+    SuccinctBits();
+
+    /**************************************
+     *
+     *************************************/
+    void push_back( bool bit );
+
+    /**************************************
+     * builds the directories, call once
+     * after the last push_back
+     *************************************/
+    void freeze();
+
+    /**************************************
+     *
+     *************************************/
+    bool get( size_t pos ) const
+    {
+        return 0 != ( ( m_words[pos / 64] >> ( pos % 64 ) ) & 1 );
+    }
+
+    /**************************************
+     * ones in [0, pos)
+     *************************************/
+    size_t rank1( size_t pos ) const;
+
+    /**************************************
+     * position of the k-th one / zero,
+     * counting from 0
+     *************************************/
+    size_t select1( size_t k ) const;
+    size_t select0( size_t k ) const;
+
+    /**************************************
+     * first zero at or after pos
+     *************************************/
+    size_t next_zero( size_t pos ) const;
+
+    /**************************************
+     *
+     *************************************/
+    size_t size() const { return m_size; }
+    size_t size_in_bytes() const;
+
+private:
+    std::vector<uint64_t> m_words;
+    std::vector<uint32_t> m_rank;
+    std::vector<uint32_t> m_select1;
+    std::vector<uint32_t> m_select0;
+    size_t                m_size;
+    size_t                m_ones;
+};
+
+
+/**************************************
+ * level order unary degree sequence
+ * trie. a node takes about 1.4 bytes
+ * including its label byte (11.4 bits
+ * on the xxl list). word ids are
+ * the ranks of the terminal nodes in
+ * level order.
+ *************************************/
+class LoudsTrie
+{
+public:
+    LoudsTrie();
+
+    /**************************************
+     * sorts and deduplicates words, the
+     * views are not used afterwards
+     *************************************/
+    void build( std::vector<std::string_view>& words );
+
+    /**************************************
+     *
+     *************************************/
+    void clear();
+
+    /**************************************
+     *
+     *************************************/
+    size_t word_count() const { return m_word_count; }
+    size_t node_count() const { return m_labels.size(); }
+    size_t size_in_bytes() const;
+    size_t min_word_length() const { return m_min_word_length; }
+
+    /**************************************
+     * id of word or -1
+     *************************************/
+    ssize_t lookup( std::string_view word ) const;
+
+    /**************************************
+     *
+     *************************************/
+    std::string word( size_t id ) const;
+
+    /**************************************
+     * ids of all words contained in input,
+     * one per occurrence
+     *************************************/
+    void find_all( const uint8_t* input, size_t len, std::vector<ssize_t>& result ) const;
+
+    /**************************************
+     * id of the leftmost word contained
+     * in input (the shortest one if
+     * several start at the same position)
+     * or -1
+     *************************************/
+    ssize_t find_first( const uint8_t* input, size_t len ) const;
+
+private:
+    /**************************************
+     * child of node on label or 0, the
+     * root is never a child
+     *************************************/
+    size_t child( size_t node, uint8_t label ) const;
+
+    /**************************************
+     *
+     *************************************/
+    ssize_t word_id( size_t node ) const
+    {
+        return m_terminal.get( node ) ? static_cast<ssize_t>( m_terminal.rank1( node ) ) : -1;
+    }
+
+private:
+    SuccinctBits         m_louds;
+    SuccinctBits         m_terminal;
+    std::vector<uint8_t> m_labels;
+    size_t               m_word_count;
+    size_t               m_min_word_length;
+};
+
+}
+
+#endif /* _LOUDS_TRIE_H_ */
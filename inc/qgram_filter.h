@@ -0,0 +1,105 @@
+/*!*****************************************************************************
+ * @file qgram_filter.h
+ * @brief bitmap of the q-grams words start with, rejects inputs cheaply
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _QGRAM_FILTER_H_
+#define _QGRAM_FILTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fastdict
+{
+
+
+/* 3-grams are hashed to this many bits (128KB), 2-grams and 1-grams are
+ * used directly
+ */
+static const size_t QGRAM_FILTER_HASH_BITS = 20;
+
+
+/**************************************
+ * an input can only contain a word if
+ * it contains the first q bytes of the
+ * word. q is lowered to the length of
+ * the shortest word.
+ *************************************/
+class QGramFilter
+{
+public:
+    QGramFilter();
+
+    /**************************************
+     * q between 1 and 3
+     *************************************/
+    void build( const std::vector<std::string>& words, size_t q );
+
+    /**************************************
+     *
+     *************************************/
+    void clear();
+
+    /**************************************
+     * false if input cannot contain any
+     * of the words
+     *************************************/
+    bool may_match( const uint8_t* input, size_t len ) const;
+
+    /**************************************
+     *
+     *************************************/
+    bool empty() const { return m_bits.empty(); }
+    size_t q() const { return m_q; }
+    size_t size_in_bytes() const { return m_bits.size() * sizeof(uint64_t); }
+
+    /**************************************
+     * share of bitmap bits that are set
+     *************************************/
+    double fill_rate() const;
+
+private:
+    /**************************************
+     * key holds the last q bytes
+     *************************************/
+    uint32_t slot( uint32_t key ) const
+    {
+        if ( 3 != m_q )
+            return key;
+
+        // multiply, xorshift, multiply: q-grams differing in one byte
+        // land in unrelated slots, the top bits index the bitmap
+        uint32_t h = key * 0x9E3779B1u;
+        h ^= h >> 15;
+        h *= 0x85EBCA77u;
+        return h >> ( 32 - QGRAM_FILTER_HASH_BITS );
+    }
+
+private:
+    std::vector<uint64_t> m_bits;
+    size_t                m_q;
+    uint32_t              m_key_mask;
+};
+
+}
+
+#endif /* _QGRAM_FILTER_H_ */
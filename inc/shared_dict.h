@@ -0,0 +1,140 @@
+/*!*****************************************************************************
+ * @file shared_dict.h
+ * @brief compiled dictionary published in shared memory
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _SHARED_DICT_H_
+#define _SHARED_DICT_H_
+
+#include "dea_compiled.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fastdict
+{
+
+
+static const uint32_t SHARED_DICT_MAGIC   = 0x53434446; /* "FDCS" */
+static const uint32_t SHARED_DICT_VERSION = 1;
+
+
+/* the control segment "/<name>" only holds the generation of the current
+ * dictionary, which lives in the data segment "/<name>.<generation>"
+ */
+struct shared_dict_control_t
+{
+    uint32_t              magic;
+    uint32_t              version;
+    std::atomic<uint64_t> generation;
+};
+
+
+/* a data segment is never written after the generation pointing to it was
+ * published. all offsets are relative to the start of the segment.
+ */
+struct shared_dict_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t generation;
+    uint64_t size;
+    uint64_t word_count;
+    uint64_t min_word_length;
+    uint64_t tables_offset;
+    uint64_t word_offsets_offset;    /* word_count + 1 entries into the chars */
+    uint64_t word_chars_offset;
+};
+
+
+/*******************************************************************************
+ * a read-only mapping of the dictionary published under a name. attaching
+ * and refreshing are not thread safe against queries on the same object.
+ ******************************************************************************/
+class SharedDict
+{
+public:
+    SharedDict();
+    ~SharedDict();
+
+    SharedDict( const SharedDict& ) = delete;
+    SharedDict& operator=( const SharedDict& ) = delete;
+
+    /**************************************
+     * writes tables and words to a new
+     * data segment, then switches the
+     * generation to it. returns the new
+     * generation or 0 on error.
+     *************************************/
+    static uint64_t publish( const std::string& name,
+                             const DeaTables& tables,
+                             const std::vector<std::string>& words,
+                             size_t min_word_length );
+
+    /**************************************
+     * removes all segments of name,
+     * attached processes keep their
+     * mappings
+     *************************************/
+    static void unpublish( const std::string& name );
+
+    /**************************************
+     *
+     *************************************/
+    bool attach( const std::string& name );
+    void detach();
+
+    /**************************************
+     * maps the current generation if a
+     * newer one was published, true if
+     * the dictionary changed
+     *************************************/
+    bool refresh();
+
+    /**************************************
+     *
+     *************************************/
+    bool attached() const { return nullptr != m_header; }
+    uint64_t generation() const;
+    size_t word_count() const;
+    size_t min_word_length() const;
+    size_t size() const;
+    DeaTables tables() const;
+    std::string_view word( size_t index ) const;
+
+private:
+    /**************************************
+     *
+     *************************************/
+    bool map_generation( uint64_t generation );
+
+private:
+    std::string                  m_name;
+    const shared_dict_control_t* m_control;
+    const shared_dict_header_t*  m_header;
+};
+
+
+}
+
+#endif /* _SHARED_DICT_H_ */
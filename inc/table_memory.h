@@ -0,0 +1,105 @@
+/*!*****************************************************************************
+ * @file table_memory.h
+ * @brief page and numa aware memory for the compiled dea tables
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef _TABLE_MEMORY_H_
+#define _TABLE_MEMORY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fastdict
+{
+
+
+typedef enum {
+    TABLE_PAGES_DEFAULT,
+    TABLE_PAGES_TRANSPARENT_HUGE,
+    TABLE_PAGES_EXPLICIT_HUGE
+} table_page_mode_t;
+
+
+/**************************************
+ * a single anonymous mapping holding
+ * read-mostly tables. the mapping can
+ * be backed by transparent or explicit
+ * huge pages and bound to a numa node.
+ *************************************/
+class TableMemory
+{
+public:
+    TableMemory();
+    ~TableMemory();
+
+    TableMemory( TableMemory&& other );
+    TableMemory& operator=( TableMemory&& other );
+
+    TableMemory( const TableMemory& ) = delete;
+    TableMemory& operator=( const TableMemory& ) = delete;
+
+    /**************************************
+     * numa_node < 0 leaves the placement
+     * to the kernel (first touch)
+     *************************************/
+    bool allocate( size_t size, table_page_mode_t pages, int numa_node=-1 );
+
+    /**************************************
+     *
+     *************************************/
+    void release();
+
+    /**************************************
+     *
+     *************************************/
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    /**************************************
+     * the page mode that was actually
+     * applied, explicit huge pages fall
+     * back to transparent ones if the
+     * hugetlb pool is empty
+     *************************************/
+    table_page_mode_t pages() const { return m_pages; }
+
+    /**************************************
+     *
+     *************************************/
+    static size_t numa_node_count();
+
+    /**************************************
+     * node of the cpu the calling thread
+     * currently runs on
+     *************************************/
+    static int current_numa_node();
+
+private:
+    uint8_t*          m_data;
+    size_t            m_size;
+    size_t            m_mapped_size;
+    table_page_mode_t m_pages;
+};
+
+
+}
+
+#endif /* _TABLE_MEMORY_H_ */
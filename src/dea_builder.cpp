@@ -0,0 +1,226 @@
+/*!*****************************************************************************
+ * @file dea_builder.cpp
+ * @brief trie builder allocating from an arena
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "dea_builder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace fastdict
+{
+
+/**************************************
+ *
+ *************************************/
+DeaArena::DeaArena( size_t block_size ) :
+    m_blocks(),
+    m_block_size( block_size ),
+    m_current( nullptr ),
+    m_left( 0 ),
+    m_reserved( 0 )
+{
+}
+
+
+/**************************************
+ *
+ *************************************/
+DeaArena::~DeaArena()
+{
+    release();
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaArena::release()
+{
+    for ( uint8_t* block : m_blocks )
+    {
+        free( block );
+    }
+    m_blocks.clear();
+    m_current  = nullptr;
+    m_left     = 0;
+    m_reserved = 0;
+}
+
+
+/**************************************
+ * requests larger than a block get a
+ * block of their own. throws
+ * std::bad_alloc like the containers
+ * the arena replaces.
+ *************************************/
+void* DeaArena::allocate_bytes( size_t size, size_t alignment )
+{
+    size_t padding = ( alignment - ( reinterpret_cast<uintptr_t>( m_current ) % alignment ) ) % alignment;
+
+    if ( ( nullptr == m_current ) || ( padding + size > m_left ) )
+    {
+        size_t block_size = std::max( m_block_size, size + alignment );
+        uint8_t* block = static_cast<uint8_t*>( malloc( block_size ) );
+        if ( nullptr == block )
+        {
+            throw std::bad_alloc();
+        }
+        m_blocks.push_back( block );
+        m_reserved += block_size;
+        m_current   = block;
+        m_left      = block_size;
+        padding     = ( alignment - ( reinterpret_cast<uintptr_t>( m_current ) % alignment ) ) % alignment;
+    }
+
+    void* result = m_current + padding;
+    m_current += padding + size;
+    m_left    -= padding + size;
+    return result;
+}
+
+
+/**************************************
+ *
+ *************************************/
+DeaBuilder::DeaBuilder() :
+    m_arena(),
+    m_chunks(),
+    m_state_count( 0 ),
+    m_transition_count( 0 )
+{
+}
+
+
+/**************************************
+ * the root state is only created by
+ * the next add
+ *************************************/
+void DeaBuilder::clear()
+{
+    m_arena.release();
+    m_chunks.clear();
+    m_state_count      = 0;
+    m_transition_count = 0;
+}
+
+
+/**************************************
+ *
+ *************************************/
+uint32_t DeaBuilder::new_state()
+{
+    if ( 0 == ( m_state_count % DEA_BUILDER_CHUNK_STATES ) )
+    {
+        m_chunks.push_back( m_arena.allocate<dea_builder_state_t>( DEA_BUILDER_CHUNK_STATES ) );
+    }
+
+    dea_builder_state_t& st = mutable_state( m_state_count );
+    st.edges         = nullptr;
+    st.edge_count    = 0;
+    st.edge_capacity = 0;
+    st.word_index    = -1;
+    st.mask          = 0;
+
+    return static_cast<uint32_t>( m_state_count++ );
+}
+
+
+/**************************************
+ * full rows move to an arena block of
+ * twice the size, the old row is left
+ * behind until clear
+ *************************************/
+void DeaBuilder::insert_edge( dea_builder_state_t& source, size_t at, uint8_t label, uint32_t target )
+{
+    if ( source.edge_count == source.edge_capacity )
+    {
+        uint16_t capacity = static_cast<uint16_t>( ( 0 == source.edge_capacity ) ? 1 : std::min( 256, source.edge_capacity * 2 ) );
+        dea_builder_edge_t* edges = m_arena.allocate<dea_builder_edge_t>( capacity );
+        if ( source.edge_count > 0 )
+        {
+            memcpy( edges, source.edges, source.edge_count * sizeof(dea_builder_edge_t) );
+        }
+        source.edges         = edges;
+        source.edge_capacity = capacity;
+    }
+
+    memmove( &source.edges[at + 1], &source.edges[at], ( source.edge_count - at ) * sizeof(dea_builder_edge_t) );
+    source.edges[at].target = target;
+    source.edges[at].label  = label;
+    source.edge_count++;
+    m_transition_count++;
+}
+
+
+/**************************************
+ *
+ *************************************/
+ssize_t DeaBuilder::add( std::string_view w, size_t index, dea_mask_t mask )
+{
+    if ( w.empty() )
+    {
+        return -1;
+    }
+
+    if ( 0 == m_state_count )
+    {
+        new_state();
+    }
+
+    uint32_t s = 0;
+    for ( size_t c_idx = 0; c_idx < w.length(); c_idx++ )
+    {
+        uint8_t c = static_cast<uint8_t>( w[c_idx] );
+        dea_builder_state_t& st = mutable_state( s );
+
+        size_t at = 0;
+        while ( ( at < st.edge_count ) && ( st.edges[at].label < c ) )
+        {
+            at++;
+        }
+
+        if ( ( at < st.edge_count ) && ( st.edges[at].label == c ) )
+        {
+            s = st.edges[at].target;
+        }
+        else
+        {
+            // new_state may add a chunk, but never moves st
+            uint32_t created = new_state();
+            insert_edge( st, at, c, created );
+            s = created;
+        }
+    }
+
+    dea_builder_state_t& accepting = mutable_state( s );
+    if ( accepting.word_index < 0 )
+    {
+        accepting.word_index = static_cast<int32_t>( index );
+    }
+    accepting.mask |= mask;
+
+    return accepting.word_index;
+}
+
+}
@@ -0,0 +1,1113 @@
+/*!*****************************************************************************
+ * @file dea_compiled.cpp
+ * @brief frozen, contiguous form of the dea used for queries
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "dea_compiled.h"
+
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <utility>
+
+namespace fastdict
+{
+
+/**************************************
+ *
+ *************************************/
+static size_t align_to( size_t offset, size_t alignment )
+{
+    return ( ( offset + alignment - 1 ) / alignment ) * alignment;
+}
+
+/**************************************
+ * reports the output chain left in
+ * cursor, false once max_matches of
+ * this call are reached
+ *************************************/
+static bool drain_outputs( const DeaTables& tables, dea_mask_t mask, size_t max_matches,
+                           dea_query_cursor_t& cursor, size_t& found, std::vector<ssize_t>& result )
+{
+    while ( 0 != cursor.output )
+    {
+        if ( ( 0 != max_matches ) && ( found == max_matches ) )
+        {
+            return false;
+        }
+        const dea_compiled_state_t& st = tables.state( cursor.output );
+        if ( 0 != ( tables.word_mask( static_cast<size_t>( st.word_index ) ) & mask ) )
+        {
+            result.push_back( st.word_index );
+            found++;
+        }
+        cursor.output = st.output_link;
+    }
+    return true;
+}
+
+
+/**************************************
+ * without deadline and cancel the
+ * whole slice is a single block
+ *************************************/
+void DeaTables::find_all_limited( const uint8_t* input, size_t len, dea_mask_t mask,
+                                  const dea_query_limits_t& limits,
+                                  dea_query_cursor_t& cursor,
+                                  std::vector<ssize_t>& result ) const
+{
+    size_t found = 0;
+    size_t stop  = len;
+    bool   timed = ( nullptr != limits.cancel ) || ( std::chrono::steady_clock::time_point::max() != limits.deadline );
+
+    if ( ( 0 != limits.max_bytes ) && ( cursor.offset < len ) && ( ( len - cursor.offset ) > limits.max_bytes ) )
+    {
+        stop = cursor.offset + limits.max_bytes;
+    }
+
+    if ( !drain_outputs( *this, mask, limits.max_matches, cursor, found, result ) )
+    {
+        cursor.status = DEA_QUERY_MAX_MATCHES;
+        return;
+    }
+
+    while ( cursor.offset < stop )
+    {
+        if ( timed )
+        {
+            if ( ( nullptr != limits.cancel ) && limits.cancel->load( std::memory_order_relaxed ) )
+            {
+                cursor.status = DEA_QUERY_CANCELLED;
+                return;
+            }
+            if ( std::chrono::steady_clock::now() >= limits.deadline )
+            {
+                cursor.status = DEA_QUERY_DEADLINE;
+                return;
+            }
+        }
+
+        size_t block_end = timed ? std::min( stop, cursor.offset + DEA_QUERY_CHECK_BYTES ) : stop;
+        uint32_t s = cursor.state;
+        for ( size_t input_idx = cursor.offset; input_idx < block_end; input_idx++ )
+        {
+            s = next_state( s, input[input_idx] );
+            if ( 0 != ( m_states[s].output_mask & mask ) )
+            {
+                cursor.state  = s;
+                cursor.offset = input_idx + 1;
+                cursor.output = ( m_states[s].word_index >= 0 ) ? s : m_states[s].output_link;
+                if ( !drain_outputs( *this, mask, limits.max_matches, cursor, found, result ) )
+                {
+                    cursor.status = DEA_QUERY_MAX_MATCHES;
+                    return;
+                }
+            }
+        }
+        cursor.state  = s;
+        cursor.offset = block_end;
+    }
+
+    cursor.status = ( cursor.offset < len ) ? DEA_QUERY_MAX_BYTES : DEA_QUERY_COMPLETE;
+}
+
+
+/**************************************
+ * all lanes take the same number of
+ * steps, only the last one is shorter
+ *************************************/
+void DeaTables::find_all_interleaved( const uint8_t* input, size_t len, dea_mask_t mask,
+                                      size_t lanes, std::vector<ssize_t>& result ) const
+{
+    size_t overlap = ( m_header->max_word_length > 0 ) ? m_header->max_word_length - 1 : 0;
+
+    lanes = std::min( lanes, DEA_MAX_SCAN_LANES );
+    if ( ( lanes <= 1 ) || ( len < lanes * 4 * ( overlap + 1 ) ) )
+    {
+        find_all( input, len, mask, result );
+        return;
+    }
+
+    size_t   segment = ( len + lanes - 1 ) / lanes;
+    size_t   pos[DEA_MAX_SCAN_LANES];
+    size_t   report[DEA_MAX_SCAN_LANES];
+    size_t   end[DEA_MAX_SCAN_LANES];
+    uint32_t state[DEA_MAX_SCAN_LANES];
+
+    size_t steps = 0;
+    for ( size_t l_idx = 0; l_idx < lanes; l_idx++ )
+    {
+        report[l_idx] = std::min( len, l_idx * segment );
+        end[l_idx]    = std::min( len, report[l_idx] + segment );
+        pos[l_idx]    = ( report[l_idx] > overlap ) ? report[l_idx] - overlap : 0;
+        state[l_idx]  = 0;
+        steps = std::max( steps, end[l_idx] - pos[l_idx] );
+    }
+
+    for ( size_t step = 0; step < steps; step++ )
+    {
+        for ( size_t l_idx = 0; l_idx < lanes; l_idx++ )
+        {
+            if ( pos[l_idx] >= end[l_idx] )
+                continue;
+
+            uint32_t s = next_state( state[l_idx], input[pos[l_idx]] );
+            const dea_compiled_state_t& st = m_states[s];
+
+            // the row is needed once the other lanes had their turn
+            __builtin_prefetch( m_symbols + st.first_transition );
+            __builtin_prefetch( m_next + st.first_transition );
+
+            if ( ( 0 != ( st.output_mask & mask ) ) && ( pos[l_idx] >= report[l_idx] ) )
+            {
+                collect_outputs( s, mask, result );
+            }
+            state[l_idx] = s;
+            pos[l_idx]++;
+        }
+    }
+}
+
+
+/**************************************
+ * the split of every prefix is final
+ * before the scan reaches its end, so
+ * all words ending at a position can
+ * extend the prefixes they start at
+ *************************************/
+bool DeaTables::segment( const uint8_t* word, size_t len, dea_mask_t mask,
+                         dea_segment_mode_t mode,
+                         const std::vector<std::string>& linking,
+                         std::vector<dea_segment_t>& result ) const
+{
+    struct split_t
+    {
+        bool     reached;
+        uint32_t parts;
+        uint64_t link_bytes;
+        uint64_t score;           /* sum of squared part lengths */
+        size_t   from;
+        size_t   word_index;
+        size_t   link_length;
+    };
+
+    result.clear();
+    if ( !valid() || ( 0 == len ) )
+    {
+        return false;
+    }
+
+    std::vector<split_t> best( len + 1, split_t{ false, 0, 0, 0, 0, 0, 0 } );
+    best[0].reached = true;
+
+    // candidate: the part word_index of length part_len after the split of
+    // [0, from) and a linking element of link_len bytes
+    auto consider = [&]( size_t end, size_t from, size_t part_len, size_t link_len, size_t word_index )
+    {
+        const split_t& prev = best[from];
+        split_t cand = { true, prev.parts + 1, prev.link_bytes + link_len,
+                         prev.score + part_len * part_len, from, word_index, link_len };
+        split_t& cur = best[end];
+
+        bool better = !cur.reached;
+        if ( !better && ( DEA_SEGMENT_FEWEST_PARTS == mode ) )
+        {
+            better = ( cand.parts < cur.parts ) ||
+                     ( ( cand.parts == cur.parts ) && ( cand.link_bytes < cur.link_bytes ) ) ||
+                     ( ( cand.parts == cur.parts ) && ( cand.link_bytes == cur.link_bytes ) && ( cand.score > cur.score ) );
+        }
+        else if ( !better )
+        {
+            better = ( cand.score > cur.score ) ||
+                     ( ( cand.score == cur.score ) && ( cand.parts < cur.parts ) ) ||
+                     ( ( cand.score == cur.score ) && ( cand.parts == cur.parts ) && ( cand.link_bytes < cur.link_bytes ) );
+        }
+        if ( better )
+        {
+            cur = cand;
+        }
+    };
+
+    uint32_t s = 0;
+    for ( size_t input_idx = 0; input_idx < len; input_idx++ )
+    {
+        s = next_state( s, word[input_idx] );
+        if ( 0 == ( m_states[s].output_mask & mask ) )
+        {
+            continue;
+        }
+
+        size_t   end = input_idx + 1;
+        uint32_t o = ( m_states[s].word_index >= 0 ) ? s : m_states[s].output_link;
+        for ( ; 0 != o; o = m_states[o].output_link )
+        {
+            size_t word_index = static_cast<size_t>( m_states[o].word_index );
+            if ( 0 == ( m_word_masks[word_index] & mask ) )
+            {
+                continue;
+            }
+
+            size_t part_len = m_states[o].depth;
+            size_t start    = end - part_len;
+            if ( best[start].reached )
+            {
+                consider( end, start, part_len, 0, word_index );
+            }
+            for ( const std::string& link : linking )
+            {
+                size_t link_len = link.length();
+                if ( ( link_len > 0 ) && ( link_len < start ) && best[start - link_len].reached &&
+                     ( 0 == memcmp( word + start - link_len, link.data(), link_len ) ) )
+                {
+                    consider( end, start - link_len, part_len, link_len, word_index );
+                }
+            }
+        }
+    }
+
+    if ( !best[len].reached )
+    {
+        return false;
+    }
+
+    for ( size_t end = len; end > 0; end = best[end].from )
+    {
+        const split_t& split = best[end];
+        result.push_back( { split.word_index, split.from + split.link_length,
+                            end - split.from - split.link_length, split.link_length } );
+    }
+    std::reverse( result.begin(), result.end() );
+
+    return true;
+}
+
+
+DeaCompiled::DeaCompiled() :
+    m_tables(),
+    m_replicas(),
+    m_pages( TABLE_PAGES_DEFAULT ),
+    m_numa_replicate( false ),
+    m_layout( DEA_LAYOUT_INSERTION ),
+    m_encoding( DEA_ENCODING_HYBRID ),
+    m_case_fold( DEA_CASE_SENSITIVE ),
+    m_visits(),
+    m_order()
+{
+}
+
+
+/**************************************
+ *
+ *************************************/
+dea_compiled_header_t DeaCompiled::make_header( size_t state_count, size_t transition_count, size_t word_count )
+{
+    dea_compiled_header_t header;
+    memset( &header, 0, sizeof(header) );
+    header.magic             = DEA_COMPILED_MAGIC;
+    header.version           = DEA_COMPILED_VERSION;
+    header.state_count       = static_cast<uint32_t>( state_count );
+    header.transition_count  = static_cast<uint32_t>( transition_count );
+    header.word_count        = static_cast<uint32_t>( word_count );
+    header.states_offset     = align_to( sizeof(header), 64 );
+    header.symbols_offset    = header.states_offset + state_count * sizeof(dea_compiled_state_t);
+    header.next_offset       = align_to( header.symbols_offset + transition_count + DEA_SPARSE_TRANSITIONS, sizeof(uint32_t) );
+    header.word_masks_offset = align_to( header.next_offset + transition_count * sizeof(uint32_t), sizeof(dea_mask_t) );
+    header.size              = header.word_masks_offset + word_count * sizeof(dea_mask_t);
+    return header;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::clear()
+{
+    m_replicas.clear();
+    m_tables.release();
+    m_order.clear();
+}
+
+
+/**************************************
+ * the trie of the builder is already
+ * sorted and free of duplicates. an
+ * empty builder has no root state yet.
+ *************************************/
+void DeaCompiled::compile( const DeaBuilder& builder, size_t word_count )
+{
+    size_t state_count = std::max<size_t>( 1, builder.state_count() );
+
+    dea_compiled_header_t header = make_header( state_count, builder.transition_count(), word_count );
+
+    m_replicas.clear();
+    m_tables.allocate( header.size, m_pages );
+
+    uint8_t*              base       = m_tables.data();
+    dea_compiled_state_t* states     = reinterpret_cast<dea_compiled_state_t*>( base + header.states_offset );
+    uint8_t*              symbols    = base + header.symbols_offset;
+    uint32_t*             next       = reinterpret_cast<uint32_t*>( base + header.next_offset );
+    dea_mask_t*           word_masks = reinterpret_cast<dea_mask_t*>( base + header.word_masks_offset );
+
+    memcpy( base, &header, sizeof(header) );
+    memset( word_masks, 0, word_count * sizeof(dea_mask_t) );
+    memset( &states[0], 0, sizeof(dea_compiled_state_t) );
+    states[0].word_index = -1;
+
+    size_t first_transition = 0;
+    for ( size_t s_idx = 0; s_idx < builder.state_count(); s_idx++ )
+    {
+        const dea_builder_state_t& source = builder.state( s_idx );
+        dea_compiled_state_t& st = states[s_idx];
+
+        st.first_transition = static_cast<uint32_t>( first_transition );
+        st.transition_count = source.edge_count;
+        st.shortcut         = 0;
+        st.fail             = 0;
+        st.word_index       = source.word_index;
+        st.output_link      = 0;
+        st.depth            = 0;
+        st.output_mask      = 0;
+
+        for ( uint16_t e_idx = 0; e_idx < source.edge_count; e_idx++ )
+        {
+            symbols[first_transition] = source.edges[e_idx].label;
+            next[first_transition]    = source.edges[e_idx].target;
+            first_transition++;
+        }
+
+        if ( st.word_index >= 0 )
+        {
+            word_masks[st.word_index] |= source.mask;
+        }
+    }
+
+    link_states();
+}
+
+
+/**************************************
+ * depths, failure and output links of
+ * freshly filled tables
+ *************************************/
+void DeaCompiled::link_states()
+{
+    uint8_t*                     base        = m_tables.data();
+    const dea_compiled_header_t& header      = *reinterpret_cast<const dea_compiled_header_t*>( base );
+    size_t                       state_count = header.state_count;
+    dea_compiled_state_t*        states      = reinterpret_cast<dea_compiled_state_t*>( base + header.states_offset );
+    uint8_t*                     symbols     = base + header.symbols_offset;
+    uint32_t*                    next        = reinterpret_cast<uint32_t*>( base + header.next_offset );
+    dea_mask_t*                  word_masks  = reinterpret_cast<dea_mask_t*>( base + header.word_masks_offset );
+
+    // breadth first over the trie: failure links of a state only depend
+    // on states closer to the root, which are complete at that point
+    DeaTables tables( base );
+    std::vector<uint32_t> queue;
+    queue.reserve( state_count );
+    queue.push_back( 0 );
+
+    uint32_t min_word_length = 0;
+    uint32_t max_word_length = 0;
+
+    for ( size_t q_idx = 0; q_idx < queue.size(); q_idx++ )
+    {
+        uint32_t u = queue[q_idx];
+        dea_compiled_state_t& su = states[u];
+
+        if ( 0 != u )
+        {
+            dea_compiled_state_t& sf = states[su.fail];
+            su.output_link = ( sf.word_index >= 0 ) ? su.fail : sf.output_link;
+            su.output_mask = sf.output_mask;
+            if ( su.word_index >= 0 )
+            {
+                su.output_mask |= word_masks[su.word_index];
+                if ( ( 0 == min_word_length ) || ( su.depth < min_word_length ) )
+                    min_word_length = su.depth;
+                if ( su.depth > max_word_length )
+                    max_word_length = su.depth;
+            }
+        }
+
+        for ( uint32_t t_idx = 0; t_idx < su.transition_count; t_idx++ )
+        {
+            uint8_t  c = symbols[su.first_transition + t_idx];
+            uint32_t v = next[su.first_transition + t_idx];
+
+            states[v].depth = su.depth + 1;
+            if ( 0 == u )
+            {
+                states[v].fail = 0;
+            }
+            else
+            {
+                uint32_t f = su.fail;
+                uint32_t t = tables.goto_state( f, c );
+                while ( ( DEA_NO_STATE == t ) && ( 0 != f ) )
+                {
+                    f = states[f].fail;
+                    t = tables.goto_state( f, c );
+                }
+                states[v].fail = ( DEA_NO_STATE == t ) ? 0 : t;
+            }
+            queue.push_back( v );
+        }
+    }
+
+    dea_compiled_header_t* written = reinterpret_cast<dea_compiled_header_t*>( base );
+    written->min_word_length = min_word_length;
+    written->max_word_length = max_word_length;
+
+    finish();
+}
+
+
+/**************************************
+ * the build order becomes the
+ * insertion order of the layouts
+ *************************************/
+void DeaCompiled::finish()
+{
+    if ( DEA_CASE_SENSITIVE != m_case_fold )
+    {
+        add_case_folding();
+    }
+
+    size_t state_count = reinterpret_cast<const dea_compiled_header_t*>( m_tables.data() )->state_count;
+
+    m_order.resize( state_count );
+    for ( size_t s_idx = 0; s_idx < state_count; s_idx++ )
+    {
+        m_order[s_idx] = static_cast<uint32_t>( s_idx );
+    }
+
+    relayout();
+
+    if ( m_numa_replicate )
+    {
+        place( m_tables );
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::set_layout( dea_layout_t layout, const std::vector<uint64_t>& visits )
+{
+    m_layout = layout;
+    m_visits = visits;
+
+    if ( nullptr != m_tables.data() )
+    {
+        relayout();
+        if ( m_numa_replicate )
+        {
+            place( m_tables );
+        }
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::record_visits( const uint8_t* input, size_t len, std::vector<uint64_t>& visits ) const
+{
+    if ( nullptr == m_tables.data() )
+    {
+        return;
+    }
+
+    if ( visits.size() != m_order.size() )
+    {
+        visits.assign( m_order.size(), 0 );
+    }
+
+    DeaTables( m_tables.data() ).count_visits( input, len, m_order.data(), visits.data() );
+}
+
+
+/**************************************
+ * appends all states not placed yet:
+ * breadth first for the shallow states
+ * every scan passes through, then each
+ * remaining subtree depth first so a
+ * walk along one word stays within a
+ * few cache lines
+ *************************************/
+static void append_layout( const DeaTables& tables, const uint32_t* next,
+                           std::vector<uint8_t>& placed, std::vector<uint32_t>& order )
+{
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> stack;
+    size_t q_idx = 0;
+
+    queue.push_back( 0 );
+    if ( 0 == placed[0] )
+    {
+        placed[0] = 1;
+        order.push_back( 0 );
+    }
+
+    // case folding lets several transitions of a state share a target,
+    // visited keeps every state to a single walk
+    std::vector<uint8_t> visited( tables.header().state_count, 0 );
+    visited[0] = 1;
+
+    while ( ( q_idx < queue.size() ) && ( order.size() < DEA_LAYOUT_BFS_STATES ) )
+    {
+        const dea_compiled_state_t& st = tables.state( queue[q_idx++] );
+        for ( uint32_t t_idx = 0; t_idx < st.transition_count; t_idx++ )
+        {
+            uint32_t v = next[st.first_transition + t_idx];
+            if ( 0 != visited[v] )
+                continue;
+            visited[v] = 1;
+            queue.push_back( v );
+            if ( 0 == placed[v] )
+            {
+                placed[v] = 1;
+                order.push_back( v );
+            }
+        }
+    }
+
+    for ( ; q_idx < queue.size(); q_idx++ )
+    {
+        stack.push_back( queue[q_idx] );
+        while ( !stack.empty() )
+        {
+            uint32_t u = stack.back();
+            stack.pop_back();
+            if ( 0 == placed[u] )
+            {
+                placed[u] = 1;
+                order.push_back( u );
+            }
+
+            const dea_compiled_state_t& st = tables.state( u );
+            for ( uint32_t t_idx = st.transition_count; t_idx > 0; t_idx-- )
+            {
+                uint32_t v = next[st.first_transition + t_idx - 1];
+                if ( 0 == visited[v] )
+                {
+                    visited[v] = 1;
+                    stack.push_back( v );
+                }
+            }
+        }
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::relayout()
+{
+    DeaTables tables( m_tables.data() );
+    uint32_t  state_count = tables.header().state_count;
+    const uint32_t* next  = reinterpret_cast<const uint32_t*>( m_tables.data() + tables.header().next_offset );
+    std::vector<uint32_t> order;
+    std::vector<uint8_t>  placed( state_count, 0 );
+    order.reserve( state_count );
+
+    if ( DEA_LAYOUT_INSERTION == m_layout )
+    {
+        order.resize( state_count );
+        for ( uint32_t s_idx = 0; s_idx < state_count; s_idx++ )
+        {
+            order[m_order[s_idx]] = s_idx;
+        }
+    }
+    else
+    {
+        if ( DEA_LAYOUT_PROFILE == m_layout )
+        {
+            if ( m_visits.size() == state_count )
+            {
+                // states visited more often than average go first, hottest
+                // first. the root has to stay state 0.
+                uint64_t total = 0;
+                for ( uint64_t count : m_visits )
+                {
+                    total += count;
+                }
+                uint64_t threshold = total / state_count + 1;
+
+                std::vector<uint32_t> hot;
+                for ( uint32_t s_idx = 1; s_idx < state_count; s_idx++ )
+                {
+                    if ( m_visits[m_order[s_idx]] >= threshold )
+                        hot.push_back( s_idx );
+                }
+                const std::vector<uint32_t>& original = m_order;
+                const std::vector<uint64_t>& visits   = m_visits;
+                std::stable_sort( hot.begin(), hot.end(),
+                                  [&original, &visits]( uint32_t a, uint32_t b )
+                                  { return visits[original[a]] > visits[original[b]]; } );
+
+                placed[0] = 1;
+                order.push_back( 0 );
+                for ( uint32_t s : hot )
+                {
+                    placed[s] = 1;
+                    order.push_back( s );
+                }
+            }
+            else
+            {
+                std::cout << "state profile does not match the dea, using breadth first layout" << std::endl;
+            }
+        }
+
+        append_layout( tables, next, placed, order );
+    }
+
+    permute( order );
+    encode();
+}
+
+
+/**************************************
+ * the dense tables are appended after
+ * the word masks, the rest of the
+ * tables keeps its offsets
+ *************************************/
+void DeaCompiled::encode()
+{
+    const dea_compiled_header_t* header = reinterpret_cast<const dea_compiled_header_t*>( m_tables.data() );
+    size_t   base_size   = header->word_masks_offset + header->word_count * sizeof(dea_mask_t);
+    uint32_t state_count = header->state_count;
+
+    std::vector<uint32_t> dense;
+    if ( DEA_ENCODING_HYBRID == m_encoding )
+    {
+        const dea_compiled_state_t* states = reinterpret_cast<const dea_compiled_state_t*>( m_tables.data() + header->states_offset );
+        for ( uint32_t s_idx = 0; ( s_idx < state_count ) && ( dense.size() < DEA_MAX_DENSE_STATES ); s_idx++ )
+        {
+            if ( states[s_idx].transition_count > DEA_SPARSE_TRANSITIONS )
+                dense.push_back( s_idx );
+        }
+    }
+
+    size_t dense_offset = align_to( base_size, 64 );
+    size_t size         = dense.empty() ? base_size : dense_offset + dense.size() * 256 * sizeof(uint32_t);
+    if ( size != header->size )
+    {
+        TableMemory target;
+        if ( !target.allocate( size, m_pages ) )
+        {
+            return;
+        }
+        memcpy( target.data(), m_tables.data(), base_size );
+        m_tables = std::move( target );
+    }
+
+    uint8_t*               base    = m_tables.data();
+    dea_compiled_header_t* written = reinterpret_cast<dea_compiled_header_t*>( base );
+    dea_compiled_state_t*  states  = reinterpret_cast<dea_compiled_state_t*>( base + written->states_offset );
+    const uint8_t*         symbols = base + written->symbols_offset;
+    const uint32_t*        next    = reinterpret_cast<const uint32_t*>( base + written->next_offset );
+
+    written->size         = size;
+    written->encoding     = m_encoding;
+    written->dense_count  = static_cast<uint32_t>( dense.size() );
+    written->dense_offset = dense.empty() ? 0 : dense_offset;
+
+    for ( uint32_t s_idx = 0; s_idx < state_count; s_idx++ )
+    {
+        states[s_idx].shortcut = 0;
+    }
+    if ( DEA_ENCODING_HYBRID != m_encoding )
+    {
+        return;
+    }
+
+    uint32_t* rows = reinterpret_cast<uint32_t*>( base + dense_offset );
+    for ( size_t d_idx = 0; d_idx < dense.size(); d_idx++ )
+    {
+        dea_compiled_state_t& st  = states[dense[d_idx]];
+        uint32_t*             row = rows + d_idx * 256;
+        for ( size_t c_idx = 0; c_idx < 256; c_idx++ )
+        {
+            row[c_idx] = DEA_NO_STATE;
+        }
+        for ( uint32_t t_idx = st.first_transition; t_idx < st.first_transition + st.transition_count; t_idx++ )
+        {
+            row[symbols[t_idx]] = next[t_idx];
+        }
+        st.shortcut = static_cast<uint16_t>( d_idx + 1 );
+    }
+
+    // a chain continues into the next state if that one follows in the
+    // tables, has a single transition and nothing to report
+    for ( uint32_t s_idx = state_count; s_idx-- > 0; )
+    {
+        dea_compiled_state_t& st = states[s_idx];
+        if ( 1 != st.transition_count )
+            continue;
+
+        uint32_t t = next[st.first_transition];
+        st.shortcut = 1;
+        if ( ( t == s_idx + 1 ) && ( 1 == states[t].transition_count ) &&
+             ( states[t].first_transition == st.first_transition + 1 ) &&
+             ( states[t].word_index < 0 ) && ( 0 == states[t].output_link ) &&
+             ( states[t].shortcut < 0xFFFF ) )
+        {
+            st.shortcut = static_cast<uint16_t>( states[t].shortcut + 1 );
+        }
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+dea_encoding_stats_t DeaTables::encoding_stats() const
+{
+    dea_encoding_stats_t stats;
+    memset( &stats, 0, sizeof(stats) );
+
+    std::vector<uint8_t> in_chain( m_header->state_count, 0 );
+    for ( uint32_t s_idx = 0; s_idx < m_header->state_count; s_idx++ )
+    {
+        const dea_compiled_state_t& st = m_states[s_idx];
+        if ( m_hybrid && ( 1 == st.transition_count ) && ( 0 == in_chain[s_idx] ) )
+        {
+            for ( uint32_t c_idx = 1; c_idx < st.shortcut; c_idx++ )
+                in_chain[s_idx + c_idx] = 1;
+        }
+
+        if ( 0 == st.transition_count )
+            stats.leaf_states++;
+        else if ( 1 == st.transition_count )
+            ( 0 != in_chain[s_idx] ) ? stats.chain_states++ : stats.single_states++;
+        else if ( !m_hybrid || ( st.transition_count <= DEA_SPARSE_TRANSITIONS ) )
+            stats.sparse_states++;
+        else if ( 0 != st.shortcut )
+            stats.dense_states++;
+        else
+            stats.binary_states++;
+    }
+    stats.dense_bytes = m_header->dense_count * 256 * sizeof(uint32_t);
+
+    return stats;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::permute( const std::vector<uint32_t>& order )
+{
+    const uint8_t*               base   = m_tables.data();
+    const dea_compiled_header_t* header = reinterpret_cast<const dea_compiled_header_t*>( base );
+    uint32_t                     state_count = header->state_count;
+
+    std::vector<uint32_t> position( state_count );
+    for ( uint32_t s_idx = 0; s_idx < state_count; s_idx++ )
+    {
+        position[order[s_idx]] = s_idx;
+    }
+
+    TableMemory target;
+    if ( !target.allocate( header->size, m_pages ) )
+    {
+        return;
+    }
+
+    uint8_t* target_base = target.data();
+    memcpy( target_base, base, header->states_offset );
+    memcpy( target_base + header->word_masks_offset, base + header->word_masks_offset,
+            header->size - header->word_masks_offset );
+
+    const dea_compiled_state_t* states         = reinterpret_cast<const dea_compiled_state_t*>( base + header->states_offset );
+    const uint8_t*              symbols        = base + header->symbols_offset;
+    const uint32_t*             next           = reinterpret_cast<const uint32_t*>( base + header->next_offset );
+    dea_compiled_state_t*       target_states  = reinterpret_cast<dea_compiled_state_t*>( target_base + header->states_offset );
+    uint8_t*                    target_symbols = target_base + header->symbols_offset;
+    uint32_t*                   target_next    = reinterpret_cast<uint32_t*>( target_base + header->next_offset );
+
+    std::vector<uint32_t> original( state_count );
+    uint32_t first_transition = 0;
+    for ( uint32_t s_idx = 0; s_idx < state_count; s_idx++ )
+    {
+        const dea_compiled_state_t& source = states[order[s_idx]];
+        dea_compiled_state_t&       st     = target_states[s_idx];
+
+        st = source;
+        st.first_transition = first_transition;
+        st.fail             = position[source.fail];
+        st.output_link      = position[source.output_link];
+
+        for ( uint32_t t_idx = 0; t_idx < source.transition_count; t_idx++ )
+        {
+            target_symbols[first_transition] = symbols[source.first_transition + t_idx];
+            target_next[first_transition]    = position[next[source.first_transition + t_idx]];
+            first_transition++;
+        }
+
+        original[s_idx] = m_order[order[s_idx]];
+    }
+
+    m_order.swap( original );
+    m_tables = std::move( target );
+}
+
+
+/**************************************
+ * the byte before a transition is the
+ * label of the transition leading to
+ * its state, so continuation bytes of
+ * utf-8 letters only get the upper
+ * case of their own lead byte
+ *************************************/
+void DeaCompiled::add_case_folding()
+{
+    const uint8_t*               base   = m_tables.data();
+    const dea_compiled_header_t* header = reinterpret_cast<const dea_compiled_header_t*>( base );
+    const dea_compiled_state_t*  states = reinterpret_cast<const dea_compiled_state_t*>( base + header->states_offset );
+    const uint8_t*               symbols = base + header->symbols_offset;
+    const uint32_t*              next    = reinterpret_cast<const uint32_t*>( base + header->next_offset );
+    DeaTables                    tables( base );
+    uint32_t                     state_count = header->state_count;
+
+    std::vector<uint8_t> label( state_count, 0 );
+    for ( uint32_t t_idx = 0; t_idx < header->transition_count; t_idx++ )
+    {
+        label[next[t_idx]] = symbols[t_idx];
+    }
+
+    std::vector<std::pair<uint8_t, uint32_t>> extra;
+    std::vector<uint32_t> extra_begin( state_count + 1, 0 );
+    for ( uint32_t s_idx = 0; s_idx < state_count; s_idx++ )
+    {
+        extra_begin[s_idx] = static_cast<uint32_t>( extra.size() );
+        const dea_compiled_state_t& st = states[s_idx];
+        for ( uint32_t t_idx = st.first_transition; t_idx < st.first_transition + st.transition_count; t_idx++ )
+        {
+            uint8_t upper = case_variant( label[s_idx], symbols[t_idx], true, m_case_fold );
+            if ( ( upper != symbols[t_idx] ) && ( DEA_NO_STATE == tables.goto_state( s_idx, upper ) ) )
+            {
+                extra.push_back( std::make_pair( upper, next[t_idx] ) );
+            }
+        }
+    }
+    extra_begin[state_count] = static_cast<uint32_t>( extra.size() );
+    if ( extra.empty() )
+    {
+        return;
+    }
+
+    dea_compiled_header_t target_header = make_header( state_count, header->transition_count + extra.size(),
+                                                       header->word_count );
+    target_header.min_word_length = header->min_word_length;
+    target_header.max_word_length = header->max_word_length;
+
+    TableMemory target;
+    if ( !target.allocate( target_header.size, m_pages ) )
+    {
+        return;
+    }
+
+    uint8_t*              target_base    = target.data();
+    dea_compiled_state_t* target_states  = reinterpret_cast<dea_compiled_state_t*>( target_base + target_header.states_offset );
+    uint8_t*              target_symbols = target_base + target_header.symbols_offset;
+    uint32_t*             target_next    = reinterpret_cast<uint32_t*>( target_base + target_header.next_offset );
+
+    memcpy( target_base, &target_header, sizeof(target_header) );
+    memcpy( target_base + target_header.word_masks_offset, base + header->word_masks_offset,
+            header->word_count * sizeof(dea_mask_t) );
+
+    std::vector<std::pair<uint8_t, uint32_t>> row;
+    uint32_t first_transition = 0;
+    for ( uint32_t s_idx = 0; s_idx < state_count; s_idx++ )
+    {
+        const dea_compiled_state_t& st = states[s_idx];
+        row.assign( extra.begin() + extra_begin[s_idx], extra.begin() + extra_begin[s_idx + 1] );
+        for ( uint32_t t_idx = st.first_transition; t_idx < st.first_transition + st.transition_count; t_idx++ )
+        {
+            row.push_back( std::make_pair( symbols[t_idx], next[t_idx] ) );
+        }
+        std::sort( row.begin(), row.end() );
+
+        target_states[s_idx] = st;
+        target_states[s_idx].first_transition = first_transition;
+        target_states[s_idx].transition_count = static_cast<uint16_t>( row.size() );
+        for ( const std::pair<uint8_t, uint32_t>& transition : row )
+        {
+            target_symbols[first_transition] = transition.first;
+            target_next[first_transition]    = transition.second;
+            first_transition++;
+        }
+    }
+
+    m_tables = std::move( target );
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::set_encoding( dea_encoding_t encoding )
+{
+    m_encoding = encoding;
+
+    if ( nullptr != m_tables.data() )
+    {
+        encode();
+        if ( m_numa_replicate )
+        {
+            place( m_tables );
+        }
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+dea_encoding_t DeaCompiled::encoding() const
+{
+    return m_encoding;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::set_case_folding( dea_case_fold_t fold )
+{
+    m_case_fold = fold;
+}
+
+/**************************************
+ *
+ *************************************/
+dea_case_fold_t DeaCompiled::case_folding() const
+{
+    return m_case_fold;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::set_placement( table_page_mode_t pages, bool numa_replicate )
+{
+    m_pages = pages;
+    m_numa_replicate = numa_replicate;
+
+    if ( nullptr != m_tables.data() )
+    {
+        place( m_tables );
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::place( TableMemory& source )
+{
+    TableMemory placed;
+    if ( !placed.allocate( source.size(), m_pages ) )
+    {
+        return;
+    }
+    memcpy( placed.data(), source.data(), source.size() );
+
+    m_replicas.clear();
+    size_t node_count = TableMemory::numa_node_count();
+    if ( m_numa_replicate && ( node_count > 1 ) )
+    {
+        for ( size_t node = 0; node < node_count; node++ )
+        {
+            TableMemory replica;
+            if ( replica.allocate( source.size(), m_pages, static_cast<int>( node ) ) )
+            {
+                memcpy( replica.data(), source.data(), source.size() );
+            }
+            m_replicas.push_back( std::move( replica ) );
+        }
+    }
+
+    m_tables = std::move( placed );
+}
+
+
+/**************************************
+ *
+ *************************************/
+DeaTables DeaCompiled::tables() const
+{
+    if ( !m_replicas.empty() )
+    {
+        size_t node = static_cast<size_t>( TableMemory::current_numa_node() );
+        if ( ( node < m_replicas.size() ) && ( nullptr != m_replicas[node].data() ) )
+        {
+            return DeaTables( m_replicas[node].data() );
+        }
+    }
+
+    if ( nullptr == m_tables.data() )
+    {
+        return DeaTables();
+    }
+
+    return DeaTables( m_tables.data() );
+}
+
+
+/**************************************
+ *
+ *************************************/
+size_t DeaCompiled::table_size() const
+{
+    return m_tables.size();
+}
+
+/**************************************
+ *
+ *************************************/
+table_page_mode_t DeaCompiled::pages() const
+{
+    return m_tables.pages();
+}
+
+/**************************************
+ *
+ *************************************/
+size_t DeaCompiled::replica_count() const
+{
+    return m_replicas.size();
+}
+
+/**************************************
+ *
+ *************************************/
+dea_layout_t DeaCompiled::layout() const
+{
+    return m_layout;
+}
+
+}
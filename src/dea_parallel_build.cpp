@@ -0,0 +1,396 @@
+/*!*****************************************************************************
+ * @file dea_parallel_build.cpp
+ * @brief builds the compiled dea tables from a word list on several threads
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "dea_compiled.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace fastdict
+{
+
+/* the sub trie of all words starting with the same byte. local node 0 is
+ * the state reached from the root on that byte, the other nodes are
+ * numbered depth first in the order the sorted words create them.
+ */
+struct dea_subtrie_t
+{
+    std::vector<uint32_t> words;          /* word indices, sorted by word */
+    std::vector<uint32_t> parent;         /* per node */
+    std::vector<uint8_t>  label;          /* per node */
+    std::vector<uint32_t> depth;          /* per node */
+    std::vector<int32_t>  word_index;     /* per node */
+    std::vector<uint32_t> child_begin;    /* per node + 1, into children */
+    std::vector<uint32_t> children;       /* grouped by parent, by label */
+    uint32_t              state_base;
+    uint32_t              transition_base;
+};
+
+
+/**************************************
+ * runs fn( thread_idx ) on threads
+ *************************************/
+static void run_threads( size_t threads, const std::function<void( size_t )>& fn )
+{
+    std::vector<std::thread> workers;
+    for ( size_t t_idx = 1; t_idx < threads; t_idx++ )
+    {
+        workers.push_back( std::thread( fn, t_idx ) );
+    }
+    fn( 0 );
+    for ( std::thread& worker : workers )
+    {
+        worker.join();
+    }
+}
+
+
+/**************************************
+ * fn( begin, end ) on equal slices of
+ * [0, count)
+ *************************************/
+static void parallel_for( size_t count, size_t threads, const std::function<void( size_t, size_t )>& fn )
+{
+    if ( ( threads <= 1 ) || ( count < 4096 ) )
+    {
+        fn( 0, count );
+        return;
+    }
+
+    run_threads( threads, [count, threads, &fn]( size_t t_idx )
+    {
+        fn( count * t_idx / threads, count * ( t_idx + 1 ) / threads );
+    } );
+}
+
+
+/**************************************
+ * the word lists are sorted, so each
+ * word only adds the nodes below its
+ * common prefix with the previous word
+ *************************************/
+static void build_subtrie( dea_subtrie_t& sub,
+                           const std::vector<std::string>& words,
+                           std::vector<int32_t>& duplicate_of )
+{
+    std::sort( sub.words.begin(), sub.words.end(),
+               [&words]( uint32_t a, uint32_t b )
+               {
+                   int cmp = words[a].compare( words[b] );
+                   return ( cmp < 0 ) || ( ( 0 == cmp ) && ( a < b ) );
+               } );
+
+    std::vector<uint32_t> path;
+    const std::string*    previous = nullptr;
+
+    for ( uint32_t w_idx : sub.words )
+    {
+        const std::string& w = words[w_idx];
+        size_t common = 0;
+
+        if ( nullptr == previous )
+        {
+            sub.parent.push_back( 0 );
+            sub.label.push_back( static_cast<uint8_t>( w[0] ) );
+            sub.depth.push_back( 1 );
+            sub.word_index.push_back( -1 );
+            path.push_back( 0 );
+            common = 1;
+        }
+        else
+        {
+            size_t limit = std::min( w.length(), previous->length() );
+            while ( ( common < limit ) && ( w[common] == (*previous)[common] ) )
+            {
+                common++;
+            }
+        }
+        path.resize( common );
+
+        for ( size_t c_idx = common; c_idx < w.length(); c_idx++ )
+        {
+            uint32_t node = static_cast<uint32_t>( sub.parent.size() );
+            sub.parent.push_back( path.back() );
+            sub.label.push_back( static_cast<uint8_t>( w[c_idx] ) );
+            sub.depth.push_back( static_cast<uint32_t>( c_idx + 1 ) );
+            sub.word_index.push_back( -1 );
+            path.push_back( node );
+        }
+
+        int32_t& accepting = sub.word_index[path[w.length() - 1]];
+        if ( accepting < 0 )
+            accepting = static_cast<int32_t>( w_idx );
+        else
+            duplicate_of[w_idx] = accepting;
+
+        previous = &w;
+    }
+
+    // nodes are created in label order per parent, a stable counting sort
+    // by parent keeps that order within every row
+    size_t node_count = sub.parent.size();
+    sub.child_begin.assign( node_count + 1, 0 );
+    for ( size_t n_idx = 1; n_idx < node_count; n_idx++ )
+    {
+        sub.child_begin[sub.parent[n_idx] + 1]++;
+    }
+    for ( size_t n_idx = 0; n_idx < node_count; n_idx++ )
+    {
+        sub.child_begin[n_idx + 1] += sub.child_begin[n_idx];
+    }
+    sub.children.resize( ( node_count > 0 ) ? node_count - 1 : 0 );
+    std::vector<uint32_t> fill( sub.child_begin.begin(), sub.child_begin.end() - 1 );
+    for ( size_t n_idx = 1; n_idx < node_count; n_idx++ )
+    {
+        sub.children[fill[sub.parent[n_idx]]++] = static_cast<uint32_t>( n_idx );
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void DeaCompiled::compile_parallel( std::vector<std::string>& words,
+                                    std::vector<dea_mask_t>& masks,
+                                    size_t threads )
+{
+    if ( 0 == threads )
+    {
+        threads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+    }
+
+    // partition by first byte
+    std::vector<dea_subtrie_t> subtries( 256 );
+    for ( size_t w_idx = 0; w_idx < words.size(); w_idx++ )
+    {
+        if ( !words[w_idx].empty() )
+        {
+            subtries[static_cast<uint8_t>( words[w_idx][0] )].words.push_back( static_cast<uint32_t>( w_idx ) );
+        }
+    }
+
+    // largest partitions first, so no thread is left with a big one at the end
+    std::vector<size_t> schedule;
+    for ( size_t b_idx = 0; b_idx < 256; b_idx++ )
+    {
+        if ( !subtries[b_idx].words.empty() )
+            schedule.push_back( b_idx );
+    }
+    std::sort( schedule.begin(), schedule.end(),
+               [&subtries]( size_t a, size_t b ) { return subtries[a].words.size() > subtries[b].words.size(); } );
+
+    std::vector<int32_t> duplicate_of( words.size(), -1 );
+    std::atomic<size_t>  next_subtrie( 0 );
+    run_threads( std::min( threads, std::max<size_t>( 1, schedule.size() ) ), [&]( size_t )
+    {
+        for ( size_t s_idx = next_subtrie++; s_idx < schedule.size(); s_idx = next_subtrie++ )
+        {
+            build_subtrie( subtries[schedule[s_idx]], words, duplicate_of );
+        }
+    } );
+
+    // drop duplicates, the first occurrence keeps the combined mask
+    std::vector<int32_t> new_index( words.size(), -1 );
+    size_t word_count = 0;
+    for ( size_t w_idx = 0; w_idx < words.size(); w_idx++ )
+    {
+        if ( words[w_idx].empty() )
+            continue;
+        if ( duplicate_of[w_idx] >= 0 )
+        {
+            masks[new_index[duplicate_of[w_idx]]] |= masks[w_idx];
+            continue;
+        }
+        new_index[w_idx] = static_cast<int32_t>( word_count );
+        if ( word_count != w_idx )
+        {
+            words[word_count] = std::move( words[w_idx] );
+            masks[word_count] = masks[w_idx];
+        }
+        word_count++;
+    }
+    words.resize( word_count );
+    masks.resize( word_count );
+
+    // stitch the sub tries under the root
+    size_t state_count      = 1;
+    size_t transition_count = schedule.size();
+    for ( size_t b_idx = 0; b_idx < 256; b_idx++ )
+    {
+        dea_subtrie_t& sub = subtries[b_idx];
+        sub.state_base      = static_cast<uint32_t>( state_count );
+        sub.transition_base = static_cast<uint32_t>( transition_count );
+        state_count        += sub.parent.size();
+        transition_count   += sub.children.size();
+    }
+
+    dea_compiled_header_t header = make_header( state_count, transition_count, word_count );
+
+    m_replicas.clear();
+    m_tables.allocate( header.size, m_pages );
+
+    uint8_t*              base       = m_tables.data();
+    dea_compiled_state_t* states     = reinterpret_cast<dea_compiled_state_t*>( base + header.states_offset );
+    uint8_t*              symbols    = base + header.symbols_offset;
+    uint32_t*             next       = reinterpret_cast<uint32_t*>( base + header.next_offset );
+    dea_mask_t*           word_masks = reinterpret_cast<dea_mask_t*>( base + header.word_masks_offset );
+
+    memcpy( base, &header, sizeof(header) );
+    if ( word_count > 0 )
+    {
+        memcpy( word_masks, masks.data(), word_count * sizeof(dea_mask_t) );
+    }
+
+    std::vector<uint32_t> parent( state_count, 0 );
+    std::vector<uint8_t>  label( state_count, 0 );
+
+    memset( &states[0], 0, sizeof(dea_compiled_state_t) );
+    states[0].word_index       = -1;
+    states[0].transition_count = static_cast<uint16_t>( schedule.size() );
+    uint32_t root_transition = 0;
+    for ( size_t b_idx = 0; b_idx < 256; b_idx++ )
+    {
+        if ( !subtries[b_idx].parent.empty() )
+        {
+            symbols[root_transition] = static_cast<uint8_t>( b_idx );
+            next[root_transition]    = subtries[b_idx].state_base;
+            root_transition++;
+        }
+    }
+
+    next_subtrie = 0;
+    run_threads( std::min( threads, std::max<size_t>( 1, schedule.size() ) ), [&]( size_t )
+    {
+        for ( size_t s_idx = next_subtrie++; s_idx < schedule.size(); s_idx = next_subtrie++ )
+        {
+            dea_subtrie_t& sub = subtries[schedule[s_idx]];
+            for ( uint32_t n_idx = 0; n_idx < sub.parent.size(); n_idx++ )
+            {
+                uint32_t s = sub.state_base + n_idx;
+                dea_compiled_state_t& st = states[s];
+                st.first_transition = sub.transition_base + sub.child_begin[n_idx];
+                st.transition_count = static_cast<uint16_t>( sub.child_begin[n_idx + 1] - sub.child_begin[n_idx] );
+                st.shortcut         = 0;
+                st.fail             = 0;
+                st.word_index       = ( sub.word_index[n_idx] >= 0 ) ? new_index[sub.word_index[n_idx]] : -1;
+                st.output_link      = 0;
+                st.depth            = sub.depth[n_idx];
+                st.output_mask      = 0;
+
+                parent[s] = ( 0 == n_idx ) ? 0 : sub.state_base + sub.parent[n_idx];
+                label[s]  = sub.label[n_idx];
+
+                for ( uint32_t t_idx = sub.child_begin[n_idx]; t_idx < sub.child_begin[n_idx + 1]; t_idx++ )
+                {
+                    uint32_t child = sub.children[t_idx];
+                    symbols[sub.transition_base + t_idx] = sub.label[child];
+                    next[sub.transition_base + t_idx]    = sub.state_base + child;
+                }
+            }
+        }
+    } );
+    subtries.clear();
+
+    // failure links level by level: a level only reads failure links and
+    // outputs of the levels above, which are complete
+    uint32_t max_depth = 0;
+    for ( size_t s_idx = 1; s_idx < state_count; s_idx++ )
+    {
+        max_depth = std::max( max_depth, states[s_idx].depth );
+    }
+    std::vector<uint32_t> level_begin( max_depth + 2, 0 );
+    for ( size_t s_idx = 1; s_idx < state_count; s_idx++ )
+    {
+        level_begin[states[s_idx].depth + 1]++;
+    }
+    for ( size_t d_idx = 0; d_idx <= max_depth; d_idx++ )
+    {
+        level_begin[d_idx + 1] += level_begin[d_idx];
+    }
+    std::vector<uint32_t> levels( state_count - 1 );
+    std::vector<uint32_t> fill( level_begin.begin(), level_begin.end() - 1 );
+    for ( size_t s_idx = 1; s_idx < state_count; s_idx++ )
+    {
+        levels[fill[states[s_idx].depth]++] = static_cast<uint32_t>( s_idx );
+    }
+
+    DeaTables tables( base );
+    uint32_t  min_word_length = 0;
+    uint32_t  max_word_length = 0;
+    for ( uint32_t depth = 1; depth <= max_depth; depth++ )
+    {
+        parallel_for( level_begin[depth + 1] - level_begin[depth], threads, [&]( size_t begin, size_t end )
+        {
+            for ( size_t l_idx = begin; l_idx < end; l_idx++ )
+            {
+                uint32_t v = levels[level_begin[depth] + l_idx];
+                dea_compiled_state_t& sv = states[v];
+
+                if ( 1 == depth )
+                {
+                    sv.fail = 0;
+                }
+                else
+                {
+                    uint32_t f = states[parent[v]].fail;
+                    uint32_t t = tables.goto_state( f, label[v] );
+                    while ( ( DEA_NO_STATE == t ) && ( 0 != f ) )
+                    {
+                        f = states[f].fail;
+                        t = tables.goto_state( f, label[v] );
+                    }
+                    sv.fail = ( DEA_NO_STATE == t ) ? 0 : t;
+                }
+
+                const dea_compiled_state_t& sf = states[sv.fail];
+                sv.output_link = ( sf.word_index >= 0 ) ? sv.fail : sf.output_link;
+                sv.output_mask = sf.output_mask;
+                if ( sv.word_index >= 0 )
+                {
+                    sv.output_mask |= word_masks[sv.word_index];
+                }
+            }
+        } );
+
+        for ( size_t l_idx = level_begin[depth]; l_idx < level_begin[depth + 1]; l_idx++ )
+        {
+            if ( states[levels[l_idx]].word_index >= 0 )
+            {
+                if ( 0 == min_word_length )
+                    min_word_length = depth;
+                max_word_length = depth;
+                break;
+            }
+        }
+    }
+
+    dea_compiled_header_t* written = reinterpret_cast<dea_compiled_header_t*>( base );
+    written->min_word_length = min_word_length;
+    written->max_word_length = max_word_length;
+
+    finish();
+}
+
+}
@@ -0,0 +1,160 @@
+/*!*****************************************************************************
+ * @file dea_scanner.cpp
+ * @brief resumable scan of a stream on the compiled dea
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "dea_scanner.h"
+
+namespace fastdict
+{
+
+DeaMatchSink::DeaMatchSink( size_t capacity ) :
+    m_buffer( ( capacity > 0 ) ? capacity : 1 ),
+    m_head( 0 ),
+    m_count( 0 )
+{
+}
+
+/**************************************
+ *
+ *************************************/
+bool DeaMatchSink::push( const dea_match_t& match )
+{
+    if ( full() )
+    {
+        return false;
+    }
+    m_buffer[( m_head + m_count ) % m_buffer.size()] = match;
+    m_count++;
+    return true;
+}
+
+/**************************************
+ *
+ *************************************/
+bool DeaMatchSink::pop( dea_match_t& match )
+{
+    if ( empty() )
+    {
+        return false;
+    }
+    match  = m_buffer[m_head];
+    m_head = ( m_head + 1 ) % m_buffer.size();
+    m_count--;
+    return true;
+}
+
+
+DeaScanner::DeaScanner( const DeaTables& tables, dea_mask_t mask ) :
+    m_tables( tables ),
+    m_mask( mask ),
+    m_state( 0 ),
+    m_output( 0 ),
+    m_position( 0 ),
+    m_data( nullptr ),
+    m_length( 0 ),
+    m_offset( 0 )
+{
+}
+
+/**************************************
+ *
+ *************************************/
+void DeaScanner::reset()
+{
+    m_state    = 0;
+    m_output   = 0;
+    m_position = 0;
+    m_data     = nullptr;
+    m_length   = 0;
+    m_offset   = 0;
+}
+
+/**************************************
+ *
+ *************************************/
+void DeaScanner::feed( const uint8_t* data, size_t len )
+{
+    m_data   = data;
+    m_length = len;
+    m_offset = 0;
+}
+
+/**************************************
+ * m_output is the next state of the
+ * chain whose word was not pushed yet,
+ * the matches end at m_position
+ *************************************/
+bool DeaScanner::flush( DeaMatchSink& sink )
+{
+    while ( 0 != m_output )
+    {
+        const dea_compiled_state_t& st = m_tables.state( m_output );
+        size_t word_index = static_cast<size_t>( st.word_index );
+        if ( 0 != ( m_tables.word_mask( word_index ) & m_mask ) )
+        {
+            if ( !sink.push( { word_index, m_position } ) )
+            {
+                return false;
+            }
+        }
+        m_output = st.output_link;
+    }
+    return true;
+}
+
+/**************************************
+ *
+ *************************************/
+dea_scan_status_t DeaScanner::resume( size_t max_bytes, DeaMatchSink& sink )
+{
+    if ( !flush( sink ) )
+    {
+        return DEA_SCAN_SINK_FULL;
+    }
+    if ( !m_tables.valid() )
+    {
+        m_position += m_length - m_offset;
+        m_offset    = m_length;
+        return DEA_SCAN_DONE;
+    }
+
+    size_t stop = ( ( m_length - m_offset ) > max_bytes ) ? m_offset + max_bytes : m_length;
+    while ( m_offset < stop )
+    {
+        m_state = m_tables.next_state( m_state, m_data[m_offset] );
+        m_offset++;
+        m_position++;
+
+        const dea_compiled_state_t& st = m_tables.state( m_state );
+        if ( 0 != ( st.output_mask & m_mask ) )
+        {
+            m_output = ( st.word_index >= 0 ) ? m_state : st.output_link;
+            if ( !flush( sink ) )
+            {
+                return DEA_SCAN_SINK_FULL;
+            }
+        }
+    }
+
+    return ( m_offset < m_length ) ? DEA_SCAN_BUDGET : DEA_SCAN_DONE;
+}
+
+}
@@ -29,11 +29,24 @@
 
 namespace fastdict
 {
-FastDict::FastDict( const std::string input_list_name, EConvertChars conv ) :
+FastDict::FastDict( const std::string& input_list_name, EConvertChars conv ) :
     m_words(),
     m_list_fname(input_list_name),
     m_conv( conv ),
-    m_contains_dea()
+    m_min_word_length( 0 ),
+    m_build_threads( 1 ),
+    m_parallel_build( false ),
+    m_scan_lanes( 1 ),
+    m_prefilter_q( 0 ),
+    m_prefilter(),
+    m_word_masks(),
+    m_builder(),
+    m_compiled(),
+    m_reverse_enabled( false ),
+    m_reverse(),
+    m_backend( eAutomaton ),
+    m_succinct(),
+    m_shared()
 {
 }
 
@@ -50,6 +63,14 @@ FastDict::operator const std::vector<std::string>&()
  *************************************/
 size_t FastDict::size() const
 {
+    if ( eSuccinct == m_backend )
+    {
+        return m_succinct.word_count();
+    }
+    if ( eShared == m_backend )
+    {
+        return m_shared.word_count();
+    }
     return m_words.size();
 }
 
@@ -57,61 +78,754 @@ size_t FastDict::size() const
 /**************************************
  *
  *************************************/
-void FastDict::print_dea()
+FastDict::EBackend FastDict::backend() const
+{
+    return m_backend;
+}
+
+
+/**************************************
+ *
+ *************************************/
+std::string FastDict::word_at( size_t index ) const
+{
+    if ( eSuccinct == m_backend )
+    {
+        return m_succinct.word( index );
+    }
+    if ( eShared == m_backend )
+    {
+        return std::string( m_shared.word( index ) );
+    }
+    return m_words[index];
+}
+
+
+/**************************************
+ *
+ *************************************/
+DeaTables FastDict::tables() const
+{
+    if ( eShared == m_backend )
+    {
+        return m_shared.tables();
+    }
+    return m_compiled.tables();
+}
+
+
+/**************************************
+ *
+ *************************************/
+size_t FastDict::min_word_length() const
+{
+    return m_min_word_length;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::set_table_placement( table_page_mode_t pages, bool numa_replicate )
+{
+    m_compiled.set_placement( pages, numa_replicate );
+    m_reverse.set_placement( pages, numa_replicate );
+}
+
+
+/**************************************
+ *
+ *************************************/
+size_t FastDict::table_size() const
+{
+    if ( eSuccinct == m_backend )
+    {
+        return m_succinct.size_in_bytes();
+    }
+    if ( eShared == m_backend )
+    {
+        return m_shared.size();
+    }
+    return m_compiled.table_size() + ( m_reverse_enabled ? m_reverse.table_size() : 0 );
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::set_build_threads( size_t threads )
+{
+    m_build_threads = threads;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::set_scan_lanes( size_t lanes )
+{
+    m_scan_lanes = std::max<size_t>( 1, std::min( lanes, DEA_MAX_SCAN_LANES ) );
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::set_prefilter( size_t q )
+{
+    m_prefilter_q = q;
+    build_prefilter();
+}
+
+
+/**************************************
+ *
+ *************************************/
+const QGramFilter& FastDict::prefilter() const
+{
+    return m_prefilter;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::set_state_layout( dea_layout_t layout )
+{
+    m_compiled.set_layout( layout );
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::set_state_encoding( dea_encoding_t encoding )
+{
+    m_compiled.set_encoding( encoding );
+    m_reverse.set_encoding( encoding );
+}
+
+
+/**************************************
+ *
+ *************************************/
+dea_encoding_stats_t FastDict::encoding_stats() const
+{
+    dea_encoding_stats_t stats;
+    memset( &stats, 0, sizeof(stats) );
+    if ( ( eSuccinct != m_backend ) && tables().valid() )
+    {
+        stats = tables().encoding_stats();
+    }
+    return stats;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::record_state_visits( std::string_view sequence, std::vector<uint64_t>& visits )
+{
+    m_compiled.record_visits( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), visits );
+}
+
+
+/**************************************
+ * text format: a header line with the
+ * number of states followed by one
+ * "state visits" line per visited state
+ *************************************/
+bool FastDict::save_state_profile( const std::string& filename, const std::vector<uint64_t>& visits )
+{
+    std::ofstream file( filename );
+    if ( !file )
+    {
+        std::cout << "error write file " << filename << std::endl;
+        return false;
+    }
+
+    file << "fastdict-state-profile " << visits.size() << "\n";
+    for ( size_t s_idx = 0; s_idx < visits.size(); s_idx++ )
+    {
+        if ( 0 != visits[s_idx] )
+        {
+            file << s_idx << " " << visits[s_idx] << "\n";
+        }
+    }
+
+    return static_cast<bool>( file );
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool FastDict::load_state_profile( const std::string& filename )
+{
+    std::ifstream file( filename );
+    std::string   magic;
+    size_t        state_count = 0;
+
+    if ( !( file >> magic >> state_count ) || ( "fastdict-state-profile" != magic ) )
+    {
+        std::cout << "error read state profile " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<uint64_t> visits( state_count, 0 );
+    size_t   state = 0;
+    uint64_t count = 0;
+    while ( file >> state >> count )
+    {
+        if ( state < state_count )
+        {
+            visits[state] = count;
+        }
+    }
+
+    m_compiled.set_layout( DEA_LAYOUT_PROFILE, visits );
+    return true;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::print_dea()
+{
+    DeaTables compiled = tables();
+    if ( !compiled.valid() )
+    {
+        return;
+    }
+
+    printf("dea %zu states\n", static_cast<size_t>( compiled.header().state_count ) );
+    for ( uint32_t s_idx = 0; s_idx < compiled.header().state_count; s_idx++ )
+    {
+        const dea_compiled_state_t& st = compiled.state( s_idx );
+        printf("     |--> [%u] word_index == %d fail ==> %u\n", s_idx, st.word_index, st.fail );
+        for ( uint32_t t_idx = st.first_transition; t_idx < st.first_transition + st.transition_count; t_idx++ )
+        {
+            printf("              |--> \"%c\" ==> %u\n", compiled.transition_symbol( t_idx ), compiled.transition_target( t_idx ) );
+        }
+    }
+}
+
+/**************************************
+ *
+ *************************************/
+void FastDict::load_from_list( const std::string& input_list_name,
+                               EConvertChars conv,
+                               EBackend backend )
+{
+    start_load( conv, backend );
+
+    if ( ! input_list_name.empty() )
+    {
+        m_list_fname = input_list_name;
+
+        if ( eSuccinct == backend )
+        {
+            load_succinct_from_file( input_list_name, conv );
+        }
+        else
+        {
+            load_list_from_file( input_list_name, m_words, conv );
+        }
+    }
+    else
+    {
+        m_conv = eNone;
+    }
+
+    compile_tables();
+}
+
+
+/**************************************
+ * the succinct backend builds its trie
+ * from views into words and drops them
+ *************************************/
+void FastDict::load_words( std::vector<std::string>&& words,
+                           EConvertChars conv,
+                           EBackend backend )
+{
+    start_load( conv, backend );
+
+    if ( eSuccinct == backend )
+    {
+        std::vector<std::string_view> views;
+        views.reserve( words.size() );
+        for ( std::string& w : words )
+        {
+            convert_chars( reinterpret_cast<uint8_t*>( w.data() ), w.length(), conv );
+            if ( !w.empty() )
+            {
+                views.push_back( w );
+            }
+        }
+        m_succinct.build( views );
+        m_min_word_length = m_succinct.min_word_length();
+        words.clear();
+    }
+    else
+    {
+        insert_moved_words( words, conv, DEA_DEFAULT_CATEGORY );
+    }
+
+    compile_tables();
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::start_load( EConvertChars conv, EBackend backend )
+{
+    m_builder.clear();
+    m_shared.detach();
+    m_words.clear();
+    m_word_masks.clear();
+    m_parallel_build = ( 1 != m_build_threads );
+    m_succinct.clear();
+    m_min_word_length = 0;
+    m_backend = backend;
+    m_list_fname = "";
+    m_conv = conv;
+    m_compiled.set_case_folding( ( eFoldCase == conv ) ? DEA_CASE_FOLD_UTF8 : DEA_CASE_SENSITIVE );
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::add_list( const std::string& input_list_name,
+                         dea_mask_t categories,
+                         EConvertChars conv )
+{
+    if ( eSuccinct == m_backend )
+    {
+        std::cout << "add_list is not supported by the succinct backend" << std::endl;
+    }
+    else if ( eShared == m_backend )
+    {
+        std::cout << "add_list is not supported on a shared dictionary" << std::endl;
+    }
+    else if ( ! input_list_name.empty() )
+    {
+        if ( eFoldCase == conv )
+        {
+            m_compiled.set_case_folding( DEA_CASE_FOLD_UTF8 );
+        }
+        reopen_builder();
+        load_list_from_file( input_list_name, m_words, conv, categories );
+        compile_tables();
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::add_words( std::vector<std::string>&& words,
+                          dea_mask_t categories,
+                          EConvertChars conv )
+{
+    if ( eSuccinct == m_backend )
+    {
+        std::cout << "add_words is not supported by the succinct backend" << std::endl;
+    }
+    else if ( eShared == m_backend )
+    {
+        std::cout << "add_words is not supported on a shared dictionary" << std::endl;
+    }
+    else
+    {
+        if ( eFoldCase == conv )
+        {
+            m_compiled.set_case_folding( DEA_CASE_FOLD_UTF8 );
+        }
+        reopen_builder();
+        insert_moved_words( words, conv, categories );
+        compile_tables();
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+uint64_t FastDict::publish_shared( const std::string& name )
+{
+    if ( eAutomaton != m_backend )
+    {
+        std::cout << "publish_shared needs a list loaded with the automaton backend" << std::endl;
+        return 0;
+    }
+
+    return SharedDict::publish( name, m_compiled.tables(), m_words, m_min_word_length );
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool FastDict::attach_shared( const std::string& name )
+{
+    load_from_list( "" );
+    if ( !m_shared.attach( name ) )
+    {
+        return false;
+    }
+
+    m_backend = eShared;
+    m_min_word_length = m_shared.min_word_length();
+    return true;
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool FastDict::refresh_shared()
+{
+    if ( ( eShared != m_backend ) || !m_shared.refresh() )
+    {
+        return false;
+    }
+
+    m_min_word_length = m_shared.min_word_length();
+    return true;
+}
+
+
+/**************************************
+ *
+ *************************************/
+std::vector<std::string> FastDict::get_contained_words( std::string_view sequence,
+                                                        dea_mask_t categories )
+{
+    return get_contained_words( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), categories );
+}
+
+
+/**************************************
+ *
+ *************************************/
+std::vector<std::string> FastDict::get_contained_words( const uint8_t* data,
+                                                        size_t length,
+                                                        dea_mask_t categories )
+{
+    std::vector<std::string> result_words;
+    if ( ( 0 == size() ) || ( length < m_min_word_length ) || prefilter_rejects( data, length ) )
+    {
+        return result_words;
+    }
+
+    std::vector<ssize_t> result;
+    if ( eSuccinct == m_backend )
+    {
+        if ( 0 != ( categories & DEA_DEFAULT_CATEGORY ) )
+        {
+            std::string folded;
+            m_succinct.find_all( succinct_input( data, length, folded ), length, result );
+        }
+    }
+    else if ( m_scan_lanes > 1 )
+    {
+        tables().find_all_interleaved( data, length, categories, m_scan_lanes, result );
+    }
+    else
+    {
+        tables().find_all( data, length, categories, result );
+    }
+    std::vector<ssize_t>::iterator ip; 
+    // Sorting the array 
+    std::sort(result.begin(), result.end()); 
+    // Now v becomes 1 1 2 2 3 3 3 3 7 7 8 10 
+
+    // Using std::unique 
+    ip = std::unique(result.begin(), result.end());
+    // Now v becomes {1 2 3 7 8 10 * * * * * *} 
+    // * means undefined 
+
+    // Resizing the vector so as to remove the undefined terms 
+    result.resize(std::distance(result.begin(), ip)); 
+
+    for( ssize_t index : result )
+    {
+        if ( index >= 0 )
+        {
+            result_words.push_back( word_at( static_cast<size_t>(index) ) );
+        }
+    }
+
+    return result_words;
+}
+
+
+/**************************************
+ *
+ *************************************/
+std::vector<std::string> FastDict::get_contained_words( std::string_view sequence,
+                                                        const dea_query_limits_t& limits,
+                                                        dea_query_cursor_t& cursor,
+                                                        dea_mask_t categories )
+{
+    return get_contained_words( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), limits, cursor, categories );
+}
+
+
+/**************************************
+ * the prefilter looks at the whole
+ * sequence, so only the first call of
+ * a query uses it
+ *************************************/
+std::vector<std::string> FastDict::get_contained_words( const uint8_t* data,
+                                                        size_t length,
+                                                        const dea_query_limits_t& limits,
+                                                        dea_query_cursor_t& cursor,
+                                                        dea_mask_t categories )
+{
+    std::vector<std::string> result_words;
+    if ( eSuccinct == m_backend )
+    {
+        std::cout << "limited queries are not supported by the succinct backend" << std::endl;
+        cursor.offset = length;
+        cursor.status = DEA_QUERY_COMPLETE;
+        return result_words;
+    }
+    if (    ( 0 == size() ) || ( length < m_min_word_length )
+         || ( ( 0 == cursor.offset ) && prefilter_rejects( data, length ) ) )
+    {
+        cursor.offset = length;
+        cursor.output = 0;
+        cursor.status = DEA_QUERY_COMPLETE;
+        return result_words;
+    }
+
+    std::vector<ssize_t> result;
+    tables().find_all_limited( data, length, categories, limits, cursor, result );
+
+    result_words.reserve( result.size() );
+    for ( ssize_t index : result )
+    {
+        result_words.push_back( word_at( static_cast<size_t>( index ) ) );
+    }
+    return result_words;
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool FastDict::contains_any( std::string_view sequence,
+                             dea_mask_t categories )
+{
+    return contains_any( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), categories );
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool FastDict::contains_any( const uint8_t* data,
+                             size_t length,
+                             dea_mask_t categories )
+{
+    if ( ( 0 == size() ) || ( length < m_min_word_length ) || prefilter_rejects( data, length ) )
+    {
+        return false;
+    }
+
+    if ( eSuccinct == m_backend )
+    {
+        std::string folded;
+        return ( 0 != ( categories & DEA_DEFAULT_CATEGORY ) ) && ( m_succinct.find_first( succinct_input( data, length, folded ), length ) >= 0 );
+    }
+
+    return tables().contains_any( data, length, categories );
+}
+
+
+/**************************************
+ *
+ *************************************/
+std::string FastDict::first_match( std::string_view sequence,
+                                  dea_mask_t categories )
 {
-    m_contains_dea.print();
+    return first_match( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), categories );
 }
 
+
 /**************************************
  *
  *************************************/
-void FastDict::load_from_list( const std::string input_list_name, EConvertChars conv )
+std::string FastDict::first_match( const uint8_t* data,
+                                  size_t length,
+                                  dea_mask_t categories )
 {
-    if ( ! input_list_name.empty() )
+    if ( ( 0 == size() ) || ( length < m_min_word_length ) || prefilter_rejects( data, length ) )
     {
-        m_words.clear();
-        std::vector<std::string>& input_list = m_words;
-        m_list_fname = input_list_name;
-        m_conv = conv;
+        return std::string();
+    }
 
-        load_list_from_file( input_list_name, input_list, conv );
+    ssize_t index = -1;
+    if ( eSuccinct == m_backend )
+    {
+        if ( 0 != ( categories & DEA_DEFAULT_CATEGORY ) )
+        {
+            std::string folded;
+            index = m_succinct.find_first( succinct_input( data, length, folded ), length );
+        }
     }
     else
     {
-        m_list_fname = "";
-        m_conv = eNone;
-        m_words.clear();
+        index = tables().find_first( data, length, categories );
+    }
+
+    if ( index < 0 )
+    {
+        return std::string();
     }
+
+    return word_at( static_cast<size_t>(index) );
 }
 
 
 /**************************************
  *
  *************************************/
-std::vector<std::string> FastDict::get_contained_words( const std::string sequence )
+bool FastDict::contains_word( std::string_view word )
 {
-    std::vector<std::string> result_words;
-    std::vector<ssize_t> result = m_contains_dea.find_in_string_multipass( sequence );
-    std::vector<ssize_t>::iterator ip; 
-    // Sorting the array 
-    std::sort(result.begin(), result.end()); 
-    // Now v becomes 1 1 2 2 3 3 3 3 7 7 8 10 
+    if ( ( 0 == size() ) || ( word.length() < m_min_word_length ) )
+    {
+        return false;
+    }
 
-    // Using std::unique 
-    ip = std::unique(result.begin(), result.end());
-    // Now v becomes {1 2 3 7 8 10 * * * * * *} 
-    // * means undefined 
+    if ( eSuccinct == m_backend )
+    {
+        std::string folded;
+        const uint8_t* input = succinct_input( reinterpret_cast<const uint8_t*>( word.data() ), word.length(), folded );
+        return ( m_succinct.lookup( std::string_view( reinterpret_cast<const char*>( input ), word.length() ) ) >= 0 );
+    }
 
-    // Resizing the vector so as to remove the undefined terms 
-    result.resize(std::distance(result.begin(), ip)); 
+    return ( tables().lookup( reinterpret_cast<const uint8_t*>( word.data() ), word.length() ) >= 0 );
+}
 
-    for( ssize_t index : result )
+
+/**************************************
+ *
+ *************************************/
+DeaScanner FastDict::make_scanner( dea_mask_t categories )
+{
+    if ( eSuccinct == m_backend )
     {
-        if ( index >= 0 )
+        std::cout << "scanners are not supported by the succinct backend" << std::endl;
+        return DeaScanner( DeaTables(), categories );
+    }
+    return DeaScanner( tables(), categories );
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::set_reverse_automaton( bool enabled )
+{
+    m_reverse_enabled = enabled;
+    if ( enabled && ( eAutomaton == m_backend ) )
+    {
+        compile_reverse();
+    }
+    else
+    {
+        m_reverse.clear();
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::find_anchored( const uint8_t* data,
+                              size_t length,
+                              dea_anchor_t anchor,
+                              dea_mask_t categories,
+                              bool first_only,
+                              std::vector<ssize_t>& result )
+{
+    DeaTables forward = tables();
+
+    if ( DEA_ANCHOR_PREFIX == anchor )
+    {
+        forward.find_prefixes( data, length, false, categories, first_only, result );
+    }
+    else if ( DEA_ANCHOR_FULL == anchor )
+    {
+        ssize_t index = forward.lookup( data, length );
+        if ( ( index >= 0 ) && ( 0 != ( forward.word_mask( index ) & categories ) ) )
+        {
+            result.push_back( index );
+        }
+    }
+    else if ( m_reverse_enabled && ( eAutomaton == m_backend ) && m_reverse.tables().valid() )
+    {
+        m_reverse.tables().find_prefixes( data, length, true, categories, first_only, result );
+    }
+    else
+    {
+        size_t longest = std::min<size_t>( length, forward.header().max_word_length );
+        for ( size_t suffix_len = m_min_word_length; suffix_len <= longest; suffix_len++ )
         {
-            result_words.push_back( m_words[index] );
+            ssize_t index = forward.lookup( data + length - suffix_len, suffix_len );
+            if ( ( index >= 0 ) && ( 0 != ( forward.word_mask( index ) & categories ) ) )
+            {
+                result.push_back( index );
+                if ( first_only )
+                    return;
+            }
         }
     }
+}
+
+
+/**************************************
+ *
+ *************************************/
+std::vector<std::string> FastDict::get_anchored_words( std::string_view sequence,
+                                                       dea_anchor_t anchor,
+                                                       dea_mask_t categories )
+{
+    return get_anchored_words( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), anchor, categories );
+}
+
+
+/**************************************
+ *
+ *************************************/
+std::vector<std::string> FastDict::get_anchored_words( const uint8_t* data,
+                                                       size_t length,
+                                                       dea_anchor_t anchor,
+                                                       dea_mask_t categories )
+{
+    std::vector<std::string> result_words;
+    if ( eSuccinct == m_backend )
+    {
+        std::cout << "anchored queries are not supported by the succinct backend" << std::endl;
+        return result_words;
+    }
+    if ( ( 0 == size() ) || ( length < m_min_word_length ) )
+    {
+        return result_words;
+    }
+
+    std::vector<ssize_t> result;
+    find_anchored( data, length, anchor, categories, false, result );
+    for ( ssize_t index : result )
+    {
+        result_words.push_back( word_at( static_cast<size_t>(index) ) );
+    }
 
     return result_words;
 }
@@ -120,36 +834,363 @@ std::vector<std::string> FastDict::get_contained_words( const std::string sequen
 /**************************************
  *
  *************************************/
-void FastDict::load_list_from_file( const std::string list_filename,
+bool FastDict::contains_anchored( std::string_view sequence,
+                                  dea_anchor_t anchor,
+                                  dea_mask_t categories )
+{
+    return contains_anchored( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), anchor, categories );
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool FastDict::contains_anchored( const uint8_t* data,
+                                  size_t length,
+                                  dea_anchor_t anchor,
+                                  dea_mask_t categories )
+{
+    if ( eSuccinct == m_backend )
+    {
+        std::cout << "anchored queries are not supported by the succinct backend" << std::endl;
+        return false;
+    }
+    if ( ( 0 == size() ) || ( length < m_min_word_length ) )
+    {
+        return false;
+    }
+
+    std::vector<ssize_t> result;
+    find_anchored( data, length, anchor, categories, true, result );
+    return !result.empty();
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool FastDict::segment_word( std::string_view word,
+                             std::vector<dea_segment_t>& parts,
+                             dea_segment_mode_t mode,
+                             const std::vector<std::string>& linking,
+                             dea_mask_t categories )
+{
+    parts.clear();
+    if ( eSuccinct == m_backend )
+    {
+        std::cout << "segment_word is not supported by the succinct backend" << std::endl;
+        return false;
+    }
+    if ( ( 0 == size() ) || ( word.length() < m_min_word_length ) )
+    {
+        return false;
+    }
+
+    return tables().segment( reinterpret_cast<const uint8_t*>( word.data() ), word.length(),
+                             categories, mode, linking, parts );
+}
+
+
+/**************************************
+ *
+ *************************************/
+dea_mask_t FastDict::get_contained_categories( std::string_view sequence,
+                                               dea_mask_t categories )
+{
+    return get_contained_categories( reinterpret_cast<const uint8_t*>( sequence.data() ), sequence.length(), categories );
+}
+
+
+/**************************************
+ *
+ *************************************/
+dea_mask_t FastDict::get_contained_categories( const uint8_t* data,
+                                               size_t length,
+                                               dea_mask_t categories )
+{
+    if ( ( 0 == size() ) || ( length < m_min_word_length ) || prefilter_rejects( data, length ) )
+    {
+        return 0;
+    }
+
+    if ( eSuccinct == m_backend )
+    {
+        std::string folded;
+        if ( ( 0 != ( categories & DEA_DEFAULT_CATEGORY ) ) && ( m_succinct.find_first( succinct_input( data, length, folded ), length ) >= 0 ) )
+        {
+            return DEA_DEFAULT_CATEGORY;
+        }
+        return 0;
+    }
+
+    return tables().find_categories( data, length, categories );
+}
+
+
+/**************************************
+ * bytes above 127 are only changed by
+ * eFoldCase, which expects utf-8
+ *************************************/
+void FastDict::convert_chars( uint8_t* data, size_t length, EConvertChars conv )
+{
+    switch( conv )
+    {
+        case eToLower: case_fold_lower( data, length, DEA_CASE_FOLD_ASCII ); break;
+        case eToUpper:
+            for ( size_t c_idx = 0; c_idx < length; c_idx++ )
+            {
+                if ( ( data[c_idx] >= 'a' ) && ( data[c_idx] <= 'z' ) )
+                    data[c_idx] = static_cast<uint8_t>( data[c_idx] - 0x20 );
+            }
+            break;
+        case eFoldCase: case_fold_lower( data, length, DEA_CASE_FOLD_UTF8 ); break;
+        default: break;
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+void FastDict::load_list_from_file( const std::string& list_filename,
                                     std::vector<std::string>& list,
-                                    EConvertChars conv )
+                                    EConvertChars conv,
+                                    dea_mask_t categories )
 {
-    list.clear();
     std::vector<uint8_t> file_content = get_file_buf( list_filename );
-    // process....
-    std::string str(file_content.begin(), file_content.end());
-    std::stringstream ss(str);
-    for (std::string each; std::getline(ss, each, '\n'); )
+    convert_chars( file_content.data(), file_content.size(), conv );
+
+    // the words are only copied once, into list
+    std::string_view content( reinterpret_cast<const char*>( file_content.data() ), file_content.size() );
+    size_t line_start = 0;
+    while ( line_start < content.length() )
+    {
+        size_t line_end = content.find( '\n', line_start );
+        if ( std::string_view::npos == line_end )
+        {
+            line_end = content.length();
+        }
+        std::string_view each = content.substr( line_start, line_end - line_start );
+        line_start = line_end + 1;
+
+        if ( !each.empty() && insert_word( each, list.size(), categories ) )
+        {
+            list.emplace_back(each);
+        }
+    }
+}
+
+
+/**************************************
+ * words listed in several categories
+ * share one index and carry the
+ * combined mask. the parallel build
+ * removes the duplicates itself.
+ *************************************/
+bool FastDict::insert_word( std::string_view word, size_t index, dea_mask_t categories )
+{
+    if ( ( 0 == m_min_word_length ) || ( word.length() < m_min_word_length ) )
+    {
+        m_min_word_length = word.length();
+    }
+
+    if ( m_parallel_build )
+    {
+        m_word_masks.push_back( categories );
+        return true;
+    }
+
+    return static_cast<size_t>( m_builder.add( word, index, categories ) ) == index;
+}
+
+
+/**************************************
+ * the words are moved into the word
+ * list, a first list hands over its
+ * buffer and is compacted in place
+ *************************************/
+void FastDict::insert_moved_words( std::vector<std::string>& words,
+                                   EConvertChars conv,
+                                   dea_mask_t categories )
+{
+    size_t first = m_words.size();
+    if ( m_words.empty() )
+    {
+        m_words.swap( words );
+    }
+    else
     {
-        if ( !each.empty() )
+        m_words.insert( m_words.end(), std::make_move_iterator( words.begin() ), std::make_move_iterator( words.end() ) );
+    }
+    words.clear();
+
+    size_t kept = first;
+    for ( size_t w_idx = first; w_idx < m_words.size(); w_idx++ )
+    {
+        std::string& w = m_words[w_idx];
+        convert_chars( reinterpret_cast<uint8_t*>( w.data() ), w.length(), conv );
+        if ( !w.empty() && insert_word( w, kept, categories ) )
         {
-            switch( conv )
+            if ( kept != w_idx )
             {
-                case eToLower: std::transform(each.begin(), each.end(), each.begin(), ::tolower); break;
-                case eToUpper: std::transform(each.begin(), each.end(), each.begin(), ::toupper); break;
-                default: break;
+                m_words[kept] = std::move( w );
             }
+            kept++;
+        }
+    }
+    m_words.resize( kept );
+}
+
+
+/**************************************
+ * words are added again in index
+ * order, which is the order they were
+ * first added in, so the states keep
+ * their numbers
+ *************************************/
+void FastDict::reopen_builder()
+{
+    if ( m_parallel_build || !m_builder.empty() || m_words.empty() )
+    {
+        return;
+    }
+
+    DeaTables compiled = m_compiled.tables();
+    for ( size_t w_idx = 0; w_idx < m_words.size(); w_idx++ )
+    {
+        m_builder.add( m_words[w_idx], w_idx, compiled.word_mask( w_idx ) );
+    }
+}
+
+/**************************************
+ * add_list keeps the build mode of
+ * load_from_list, a parallel build
+ * starts over from all words
+ *************************************/
+void FastDict::compile_tables()
+{
+    if ( m_parallel_build )
+    {
+        m_compiled.compile_parallel( m_words, m_word_masks, m_build_threads );
+    }
+    else
+    {
+        m_compiled.compile( m_builder, m_words.size() );
+        m_builder.clear();
+    }
+
+    if ( m_reverse_enabled )
+    {
+        compile_reverse();
+    }
+    build_prefilter();
+}
+
+/**************************************
+ * the succinct backend keeps no word
+ * list to build from, the q-grams of a
+ * case folded dictionary would only
+ * cover lower case input
+ *************************************/
+void FastDict::build_prefilter()
+{
+    if ( ( m_prefilter_q > 0 ) && ( eAutomaton == m_backend ) && ( DEA_CASE_SENSITIVE == m_compiled.case_folding() ) )
+    {
+        m_prefilter.build( m_words, m_prefilter_q );
+    }
+    else
+    {
+        m_prefilter.clear();
+    }
+}
 
-            list.push_back(each);
-            m_contains_dea.else_contains( each, list.size()-1 );
+/**************************************
+ *
+ *************************************/
+const uint8_t* FastDict::succinct_input( const uint8_t* data, size_t length, std::string& folded ) const
+{
+    if ( eFoldCase != m_conv )
+    {
+        return data;
+    }
+
+    folded.assign( reinterpret_cast<const char*>( data ), length );
+    uint8_t* bytes = reinterpret_cast<uint8_t*>( folded.data() );
+    case_fold_lower( bytes, length, DEA_CASE_FOLD_UTF8 );
+    return bytes;
+}
+
+/**************************************
+ * the reversed words keep the indices
+ * and masks of the forward tables.
+ * reversed, a continuation byte comes
+ * before the lead byte its case
+ * depends on, so a utf-8 folded
+ * dictionary gets no reverse tables
+ * and suffix queries look up every
+ * suffix in the forward tables.
+ *************************************/
+void FastDict::compile_reverse()
+{
+    if ( DEA_CASE_FOLD_UTF8 == m_compiled.case_folding() )
+    {
+        m_reverse.clear();
+        return;
+    }
+
+    DeaTables forward = m_compiled.tables();
+    std::vector<std::string> reversed;
+    std::vector<dea_mask_t>  masks;
+
+    reversed.reserve( m_words.size() );
+    masks.reserve( m_words.size() );
+    for ( size_t w_idx = 0; w_idx < m_words.size(); w_idx++ )
+    {
+        reversed.emplace_back( m_words[w_idx].rbegin(), m_words[w_idx].rend() );
+        masks.push_back( forward.word_mask( w_idx ) );
+    }
+
+    m_reverse.set_case_folding( m_compiled.case_folding() );
+    m_reverse.compile_parallel( reversed, masks, m_parallel_build ? m_build_threads : 1 );
+}
+
+/**************************************
+ * neither the automaton nor the word
+ * list is built, the trie is built
+ * from views into the file buffer
+ *************************************/
+void FastDict::load_succinct_from_file( const std::string& list_filename,
+                                        EConvertChars conv )
+{
+    std::vector<uint8_t> file_content = get_file_buf( list_filename );
+    convert_chars( file_content.data(), file_content.size(), conv );
+
+    std::vector<std::string_view> words;
+    std::string_view content( reinterpret_cast<const char*>( file_content.data() ), file_content.size() );
+    size_t line_start = 0;
+    while ( line_start < content.length() )
+    {
+        size_t line_end = content.find( '\n', line_start );
+        if ( std::string_view::npos == line_end )
+        {
+            line_end = content.length();
         }
+        if ( line_end > line_start )
+        {
+            words.push_back( content.substr( line_start, line_end - line_start ) );
+        }
+        line_start = line_end + 1;
     }
+
+    m_succinct.build( words );
+    m_min_word_length = m_succinct.min_word_length();
 }
 
+
 /**************************************
  *
  *************************************/
-std::vector<uint8_t> FastDict::get_file_buf( const std::string filename )
+std::vector<uint8_t> FastDict::get_file_buf( const std::string& filename )
 {
     std::vector<uint8_t> result_buffer;
 
@@ -0,0 +1,423 @@
+/*!*****************************************************************************
+ * @file louds_trie.cpp
+ * @brief succinct read-only trie for very large word lists
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "louds_trie.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace fastdict
+{
+
+static const size_t BITS_PER_BLOCK   = 512;
+static const size_t WORDS_PER_BLOCK  = BITS_PER_BLOCK / 64;
+static const size_t SELECT_SAMPLE    = 512;
+
+/**************************************
+ * position of the r-th one in x
+ *************************************/
+static size_t select_in_word( uint64_t x, size_t r )
+{
+    for ( size_t i = 0; i < r; i++ )
+    {
+        x &= x - 1;
+    }
+    return static_cast<size_t>( __builtin_ctzll( x ) );
+}
+
+
+SuccinctBits::SuccinctBits() :
+    m_words(),
+    m_rank(),
+    m_select1(),
+    m_select0(),
+    m_size( 0 ),
+    m_ones( 0 )
+{
+}
+
+/**************************************
+ *
+ *************************************/
+void SuccinctBits::push_back( bool bit )
+{
+    if ( 0 == ( m_size % 64 ) )
+    {
+        m_words.push_back( 0 );
+    }
+    if ( bit )
+    {
+        m_words.back() |= 1ULL << ( m_size % 64 );
+    }
+    m_size++;
+}
+
+/**************************************
+ *
+ *************************************/
+void SuccinctBits::freeze()
+{
+    m_words.shrink_to_fit();
+    m_rank.clear();
+    m_select1.clear();
+    m_select0.clear();
+
+    size_t ones = 0;
+    size_t zeros = 0;
+    for ( size_t w_idx = 0; w_idx < m_words.size(); w_idx++ )
+    {
+        if ( 0 == ( w_idx % WORDS_PER_BLOCK ) )
+        {
+            m_rank.push_back( static_cast<uint32_t>( ones ) );
+        }
+
+        size_t valid      = std::min<size_t>( 64, m_size - w_idx * 64 );
+        size_t word_ones  = static_cast<size_t>( __builtin_popcountll( m_words[w_idx] ) );
+        size_t word_zeros = valid - word_ones;
+
+        while ( ( m_select1.size() * SELECT_SAMPLE ) < ( ones + word_ones ) )
+        {
+            m_select1.push_back( static_cast<uint32_t>( w_idx ) );
+        }
+        while ( ( m_select0.size() * SELECT_SAMPLE ) < ( zeros + word_zeros ) )
+        {
+            m_select0.push_back( static_cast<uint32_t>( w_idx ) );
+        }
+
+        ones  += word_ones;
+        zeros += word_zeros;
+    }
+    m_rank.push_back( static_cast<uint32_t>( ones ) );
+    m_ones = ones;
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SuccinctBits::rank1( size_t pos ) const
+{
+    size_t block  = pos / BITS_PER_BLOCK;
+    size_t result = m_rank[block];
+
+    for ( size_t w_idx = block * WORDS_PER_BLOCK; w_idx < ( pos / 64 ); w_idx++ )
+    {
+        result += static_cast<size_t>( __builtin_popcountll( m_words[w_idx] ) );
+    }
+    if ( 0 != ( pos % 64 ) )
+    {
+        result += static_cast<size_t>( __builtin_popcountll( m_words[pos / 64] & ( ( 1ULL << ( pos % 64 ) ) - 1 ) ) );
+    }
+
+    return result;
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SuccinctBits::select1( size_t k ) const
+{
+    size_t w_idx = m_select1[k / SELECT_SAMPLE];
+    size_t r     = k - rank1( w_idx * 64 );
+
+    for (;;)
+    {
+        size_t count = static_cast<size_t>( __builtin_popcountll( m_words[w_idx] ) );
+        if ( r < count )
+        {
+            return w_idx * 64 + select_in_word( m_words[w_idx], r );
+        }
+        r -= count;
+        w_idx++;
+    }
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SuccinctBits::select0( size_t k ) const
+{
+    size_t w_idx = m_select0[k / SELECT_SAMPLE];
+    size_t r     = k - ( w_idx * 64 - rank1( w_idx * 64 ) );
+
+    for (;;)
+    {
+        size_t count = static_cast<size_t>( __builtin_popcountll( ~m_words[w_idx] ) );
+        if ( r < count )
+        {
+            return w_idx * 64 + select_in_word( ~m_words[w_idx], r );
+        }
+        r -= count;
+        w_idx++;
+    }
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SuccinctBits::next_zero( size_t pos ) const
+{
+    size_t   w_idx = pos / 64;
+    uint64_t x     = ~m_words[w_idx] & ( ~0ULL << ( pos % 64 ) );
+
+    while ( 0 == x )
+    {
+        w_idx++;
+        x = ~m_words[w_idx];
+    }
+
+    return w_idx * 64 + static_cast<size_t>( __builtin_ctzll( x ) );
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SuccinctBits::size_in_bytes() const
+{
+    return m_words.size() * sizeof(uint64_t)
+         + ( m_rank.size() + m_select1.size() + m_select0.size() ) * sizeof(uint32_t);
+}
+
+
+LoudsTrie::LoudsTrie() :
+    m_louds(),
+    m_terminal(),
+    m_labels(),
+    m_word_count( 0 ),
+    m_min_word_length( 0 )
+{
+}
+
+/**************************************
+ *
+ *************************************/
+void LoudsTrie::clear()
+{
+    m_louds        = SuccinctBits();
+    m_terminal     = SuccinctBits();
+    m_labels.clear();
+    m_labels.shrink_to_fit();
+    m_word_count   = 0;
+    m_min_word_length = 0;
+}
+
+/**************************************
+ *
+ *************************************/
+void LoudsTrie::build( std::vector<std::string_view>& words )
+{
+    struct range_t
+    {
+        size_t begin;
+        size_t end;
+        size_t depth;
+    };
+
+    clear();
+
+    std::sort( words.begin(), words.end() );
+    words.erase( std::unique( words.begin(), words.end() ), words.end() );
+
+    // super root, its single child is the root
+    m_louds.push_back( true );
+    m_louds.push_back( false );
+
+    std::deque<range_t> queue;
+    queue.push_back( { 0, words.size(), 0 } );
+    m_labels.push_back( 0 );
+
+    // level order: every node is a range of the sorted words sharing a
+    // prefix of length depth
+    while ( !queue.empty() )
+    {
+        range_t r = queue.front();
+        queue.pop_front();
+
+        size_t begin = r.begin;
+        bool   terminal = ( begin < r.end ) && ( words[begin].length() == r.depth );
+        if ( terminal )
+        {
+            begin++;
+            m_word_count++;
+            if ( ( 0 == m_min_word_length ) || ( r.depth < m_min_word_length ) )
+                m_min_word_length = r.depth;
+        }
+        m_terminal.push_back( terminal );
+
+        while ( begin < r.end )
+        {
+            char   label = words[begin][r.depth];
+            size_t end = begin + 1;
+            while ( ( end < r.end ) && ( words[end][r.depth] == label ) )
+            {
+                end++;
+            }
+            m_louds.push_back( true );
+            m_labels.push_back( static_cast<uint8_t>( label ) );
+            queue.push_back( { begin, end, r.depth + 1 } );
+            begin = end;
+        }
+        m_louds.push_back( false );
+    }
+
+    m_labels.shrink_to_fit();
+    m_louds.freeze();
+    m_terminal.freeze();
+}
+
+/**************************************
+ *
+ *************************************/
+size_t LoudsTrie::size_in_bytes() const
+{
+    return m_louds.size_in_bytes() + m_terminal.size_in_bytes() + m_labels.size();
+}
+
+/**************************************
+ * the children of node follow the
+ * node-th zero, their ids are the
+ * number of ones before them
+ *************************************/
+size_t LoudsTrie::child( size_t node, uint8_t label ) const
+{
+    size_t start = m_louds.select0( node ) + 1;
+    size_t end   = m_louds.next_zero( start );
+    size_t low   = start - node - 1;
+    size_t high  = low + ( end - start );
+
+    while ( low < high )
+    {
+        size_t mid = ( low + high ) / 2;
+        if ( m_labels[mid] < label )
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if ( ( low < ( start - node - 1 ) + ( end - start ) ) && ( m_labels[low] == label ) )
+    {
+        return low;
+    }
+    return 0;
+}
+
+/**************************************
+ *
+ *************************************/
+ssize_t LoudsTrie::lookup( std::string_view word ) const
+{
+    if ( 0 == m_word_count )
+    {
+        return -1;
+    }
+
+    size_t node = 0;
+    for ( char c : word )
+    {
+        node = child( node, static_cast<uint8_t>( c ) );
+        if ( 0 == node )
+        {
+            return -1;
+        }
+    }
+
+    return word_id( node );
+}
+
+/**************************************
+ *
+ *************************************/
+std::string LoudsTrie::word( size_t id ) const
+{
+    std::string result;
+    size_t node = m_terminal.select1( id );
+
+    while ( 0 != node )
+    {
+        result.push_back( static_cast<char>( m_labels[node] ) );
+        node = m_louds.select1( node ) - node - 1;
+    }
+
+    std::reverse( result.begin(), result.end() );
+    return result;
+}
+
+/**************************************
+ *
+ *************************************/
+void LoudsTrie::find_all( const uint8_t* input, size_t len, std::vector<ssize_t>& result ) const
+{
+    if ( ( 0 == m_word_count ) || ( len < m_min_word_length ) )
+    {
+        return;
+    }
+
+    for ( size_t start_idx = 0; ( start_idx + m_min_word_length ) <= len; start_idx++ )
+    {
+        size_t node = 0;
+        for ( size_t input_idx = start_idx; input_idx < len; input_idx++ )
+        {
+            node = child( node, input[input_idx] );
+            if ( 0 == node )
+            {
+                break;
+            }
+            ssize_t id = word_id( node );
+            if ( id >= 0 )
+            {
+                result.push_back( id );
+            }
+        }
+    }
+}
+
+/**************************************
+ *
+ *************************************/
+ssize_t LoudsTrie::find_first( const uint8_t* input, size_t len ) const
+{
+    if ( ( 0 == m_word_count ) || ( len < m_min_word_length ) )
+    {
+        return -1;
+    }
+
+    for ( size_t start_idx = 0; ( start_idx + m_min_word_length ) <= len; start_idx++ )
+    {
+        size_t node = 0;
+        for ( size_t input_idx = start_idx; input_idx < len; input_idx++ )
+        {
+            node = child( node, input[input_idx] );
+            if ( 0 == node )
+            {
+                break;
+            }
+            ssize_t id = word_id( node );
+            if ( id >= 0 )
+            {
+                return id;
+            }
+        }
+    }
+
+    return -1;
+}
+
+}
@@ -0,0 +1,148 @@
+/*!*****************************************************************************
+ * @file qgram_filter.cpp
+ * @brief bitmap of the q-grams words start with, rejects inputs cheaply
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "qgram_filter.h"
+
+#include <algorithm>
+
+namespace fastdict
+{
+
+/* inputs are tested in blocks of this many q-grams between early exits */
+static const size_t QGRAM_BLOCK = 32;
+
+QGramFilter::QGramFilter() :
+    m_bits(),
+    m_q( 0 ),
+    m_key_mask( 0 )
+{
+}
+
+/**************************************
+ *
+ *************************************/
+void QGramFilter::build( const std::vector<std::string>& words, size_t q )
+{
+    clear();
+    if ( words.empty() )
+    {
+        return;
+    }
+
+    m_q = std::max<size_t>( 1, std::min<size_t>( q, 3 ) );
+    for ( const std::string& w : words )
+    {
+        if ( !w.empty() )
+            m_q = std::min( m_q, w.length() );
+    }
+    m_key_mask = ( 3 == m_q ) ? 0xFFFFFF : ( ( 1u << ( 8 * m_q ) ) - 1 );
+
+    size_t bits = ( 3 == m_q ) ? ( size_t( 1 ) << QGRAM_FILTER_HASH_BITS ) : ( size_t( 1 ) << ( 8 * m_q ) );
+    m_bits.assign( std::max<size_t>( 1, bits / 64 ), 0 );
+
+    for ( const std::string& w : words )
+    {
+        if ( w.length() < m_q )
+            continue;
+
+        uint32_t key = 0;
+        for ( size_t c_idx = 0; c_idx < m_q; c_idx++ )
+        {
+            key = ( key << 8 ) | static_cast<uint8_t>( w[c_idx] );
+        }
+        uint32_t s = slot( key );
+        m_bits[s / 64] |= 1ULL << ( s % 64 );
+    }
+}
+
+/**************************************
+ *
+ *************************************/
+void QGramFilter::clear()
+{
+    m_bits.clear();
+    m_bits.shrink_to_fit();
+    m_q = 0;
+    m_key_mask = 0;
+}
+
+/**************************************
+ * no branch on the bitmap inside a
+ * block, the hits are or-ed together
+ *************************************/
+bool QGramFilter::may_match( const uint8_t* input, size_t len ) const
+{
+    if ( m_bits.empty() )
+    {
+        return true;
+    }
+    if ( len < m_q )
+    {
+        return false;
+    }
+
+    uint32_t key = 0;
+    for ( size_t input_idx = 0; input_idx + 1 < m_q; input_idx++ )
+    {
+        key = ( key << 8 ) | input[input_idx];
+    }
+
+    const uint64_t* bits = m_bits.data();
+    size_t input_idx = m_q - 1;
+    while ( input_idx < len )
+    {
+        size_t   block_end = std::min( len, input_idx + QGRAM_BLOCK );
+        uint64_t hits = 0;
+        for ( ; input_idx < block_end; input_idx++ )
+        {
+            key = ( ( key << 8 ) | input[input_idx] ) & m_key_mask;
+            uint32_t s = slot( key );
+            hits |= bits[s / 64] >> ( s % 64 );
+        }
+        if ( 0 != ( hits & 1 ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**************************************
+ *
+ *************************************/
+double QGramFilter::fill_rate() const
+{
+    if ( m_bits.empty() )
+    {
+        return 0.0;
+    }
+
+    size_t set = 0;
+    for ( uint64_t word : m_bits )
+    {
+        set += static_cast<size_t>( __builtin_popcountll( word ) );
+    }
+    return static_cast<double>( set ) / static_cast<double>( m_bits.size() * 64 );
+}
+
+}
@@ -0,0 +1,432 @@
+/*!*****************************************************************************
+ * @file shared_dict.cpp
+ * @brief compiled dictionary published in shared memory
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "shared_dict.h"
+
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace fastdict
+{
+
+/**************************************
+ *
+ *************************************/
+static size_t align_up( size_t size, size_t alignment )
+{
+    return ( ( size + alignment - 1 ) / alignment ) * alignment;
+}
+
+/**************************************
+ *
+ *************************************/
+static std::string control_name( const std::string& name )
+{
+    return "/" + name;
+}
+
+/**************************************
+ *
+ *************************************/
+static std::string data_name( const std::string& name, uint64_t generation )
+{
+    return "/" + name + "." + std::to_string( generation );
+}
+
+/**************************************
+ * maps the whole shm object fd refers
+ * to, size receives its length
+ *************************************/
+static void* map_fd( int fd, int prot, size_t& size )
+{
+    struct stat st;
+    if ( ( 0 != fstat( fd, &st ) ) || ( 0 == st.st_size ) )
+    {
+        return MAP_FAILED;
+    }
+    size = static_cast<size_t>( st.st_size );
+    return mmap( nullptr, size, prot, MAP_SHARED, fd, 0 );
+}
+
+
+SharedDict::SharedDict() :
+    m_name(),
+    m_control( nullptr ),
+    m_header( nullptr )
+{
+}
+
+SharedDict::~SharedDict()
+{
+    detach();
+}
+
+
+/**************************************
+ *
+ *************************************/
+uint64_t SharedDict::publish( const std::string& name,
+                              const DeaTables& tables,
+                              const std::vector<std::string>& words,
+                              size_t min_word_length )
+{
+    if ( !tables.valid() )
+    {
+        std::cout << "error publish " << name << ": no compiled tables" << std::endl;
+        return 0;
+    }
+
+    int control_fd = shm_open( control_name( name ).c_str(), O_RDWR | O_CREAT, 0644 );
+    if ( control_fd < 0 )
+    {
+        std::cout << "error open shared memory " << control_name( name ) << std::endl;
+        return 0;
+    }
+
+    struct stat st;
+    if ( ( 0 == fstat( control_fd, &st ) ) && ( static_cast<size_t>( st.st_size ) < sizeof(shared_dict_control_t) ) )
+    {
+        if ( 0 != ftruncate( control_fd, sizeof(shared_dict_control_t) ) )
+        {
+            std::cout << "error resize shared memory " << control_name( name ) << std::endl;
+        }
+    }
+
+    size_t control_size = 0;
+    void*  control_map = map_fd( control_fd, PROT_READ | PROT_WRITE, control_size );
+    close( control_fd );
+    if ( MAP_FAILED == control_map )
+    {
+        std::cout << "error mapping shared memory " << control_name( name ) << std::endl;
+        return 0;
+    }
+
+    // a new object is zero filled
+    shared_dict_control_t* control = static_cast<shared_dict_control_t*>( control_map );
+    if ( 0 == control->magic )
+    {
+        control->magic   = SHARED_DICT_MAGIC;
+        control->version = SHARED_DICT_VERSION;
+    }
+    if ( ( SHARED_DICT_MAGIC != control->magic ) || ( SHARED_DICT_VERSION != control->version ) )
+    {
+        std::cout << "error publish " << name << ": incompatible shared memory" << std::endl;
+        munmap( control_map, control_size );
+        return 0;
+    }
+
+    uint64_t previous   = control->generation.load( std::memory_order_acquire );
+    uint64_t generation = previous + 1;
+
+    size_t chars = 0;
+    for ( const std::string& w : words )
+    {
+        chars += w.length();
+    }
+
+    shared_dict_header_t header;
+    memset( &header, 0, sizeof(header) );
+    header.magic               = SHARED_DICT_MAGIC;
+    header.version             = SHARED_DICT_VERSION;
+    header.generation          = generation;
+    header.word_count          = words.size();
+    header.min_word_length     = min_word_length;
+    header.tables_offset       = align_up( sizeof(header), 64 );
+    header.word_offsets_offset = align_up( header.tables_offset + tables.header().size, 64 );
+    header.word_chars_offset   = header.word_offsets_offset + ( words.size() + 1 ) * sizeof(uint64_t);
+    header.size                = header.word_chars_offset + chars;
+
+    // a segment left over by a publisher that died is stale
+    std::string segment = data_name( name, generation );
+    shm_unlink( segment.c_str() );
+    int   fd = shm_open( segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644 );
+    void* map = MAP_FAILED;
+    size_t size = 0;
+    if ( ( fd >= 0 ) && ( 0 == ftruncate( fd, static_cast<off_t>( header.size ) ) ) )
+    {
+        map = map_fd( fd, PROT_READ | PROT_WRITE, size );
+    }
+    if ( fd >= 0 )
+    {
+        close( fd );
+    }
+    if ( MAP_FAILED == map )
+    {
+        std::cout << "error create shared memory " << segment << std::endl;
+        shm_unlink( segment.c_str() );
+        munmap( control_map, control_size );
+        return 0;
+    }
+
+    uint8_t*  base    = static_cast<uint8_t*>( map );
+    uint64_t* offsets = reinterpret_cast<uint64_t*>( base + header.word_offsets_offset );
+    char*     text    = reinterpret_cast<char*>( base + header.word_chars_offset );
+    memcpy( base, &header, sizeof(header) );
+    memcpy( base + header.tables_offset, tables.data(), tables.header().size );
+    uint64_t offset = 0;
+    for ( size_t w_idx = 0; w_idx < words.size(); w_idx++ )
+    {
+        offsets[w_idx] = offset;
+        memcpy( text + offset, words[w_idx].data(), words[w_idx].length() );
+        offset += words[w_idx].length();
+    }
+    offsets[words.size()] = offset;
+    munmap( map, size );
+
+    // readers that still map the previous generation keep it until they
+    // refresh, the name is only needed to attach
+    control->generation.store( generation, std::memory_order_release );
+    if ( 0 != previous )
+    {
+        shm_unlink( data_name( name, previous ).c_str() );
+    }
+    munmap( control_map, control_size );
+
+    return generation;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void SharedDict::unpublish( const std::string& name )
+{
+    int fd = shm_open( control_name( name ).c_str(), O_RDONLY, 0 );
+    if ( fd >= 0 )
+    {
+        size_t size = 0;
+        void*  map = map_fd( fd, PROT_READ, size );
+        close( fd );
+        if ( MAP_FAILED != map )
+        {
+            const shared_dict_control_t* control = static_cast<const shared_dict_control_t*>( map );
+            if ( SHARED_DICT_MAGIC == control->magic )
+            {
+                shm_unlink( data_name( name, control->generation.load() ).c_str() );
+            }
+            munmap( map, size );
+        }
+    }
+    shm_unlink( control_name( name ).c_str() );
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool SharedDict::attach( const std::string& name )
+{
+    detach();
+
+    int fd = shm_open( control_name( name ).c_str(), O_RDONLY, 0 );
+    if ( fd < 0 )
+    {
+        std::cout << "error open shared memory " << control_name( name ) << std::endl;
+        return false;
+    }
+    size_t size = 0;
+    void*  map = map_fd( fd, PROT_READ, size );
+    close( fd );
+    if ( ( MAP_FAILED == map ) || ( size < sizeof(shared_dict_control_t) ) )
+    {
+        std::cout << "error mapping shared memory " << control_name( name ) << std::endl;
+        if ( MAP_FAILED != map )
+            munmap( map, size );
+        return false;
+    }
+
+    m_name    = name;
+    m_control = static_cast<const shared_dict_control_t*>( map );
+    if ( ( SHARED_DICT_MAGIC != m_control->magic ) || ( SHARED_DICT_VERSION != m_control->version ) )
+    {
+        std::cout << "error attach " << name << ": incompatible shared memory" << std::endl;
+        detach();
+        return false;
+    }
+
+    if ( !refresh() )
+    {
+        std::cout << "error attach " << name << ": nothing published" << std::endl;
+        detach();
+        return false;
+    }
+    return true;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void SharedDict::detach()
+{
+    if ( nullptr != m_header )
+    {
+        munmap( const_cast<shared_dict_header_t*>( m_header ), m_header->size );
+    }
+    if ( nullptr != m_control )
+    {
+        munmap( const_cast<shared_dict_control_t*>( m_control ), sizeof(shared_dict_control_t) );
+    }
+    m_name.clear();
+    m_control = nullptr;
+    m_header  = nullptr;
+}
+
+
+/**************************************
+ * the publisher unlinks the previous
+ * segment right after switching, so a
+ * generation read here may already be
+ * gone and a newer one must be tried
+ *************************************/
+bool SharedDict::refresh()
+{
+    if ( nullptr == m_control )
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        uint64_t current = m_control->generation.load( std::memory_order_acquire );
+        if ( ( 0 == current ) || ( ( nullptr != m_header ) && ( current == m_header->generation ) ) )
+        {
+            return false;
+        }
+        if ( map_generation( current ) )
+        {
+            return true;
+        }
+        if ( current == m_control->generation.load( std::memory_order_acquire ) )
+        {
+            return false;
+        }
+    }
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool SharedDict::map_generation( uint64_t generation )
+{
+    int fd = shm_open( data_name( m_name, generation ).c_str(), O_RDONLY, 0 );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+    size_t size = 0;
+    void*  map = map_fd( fd, PROT_READ, size );
+    close( fd );
+    if ( MAP_FAILED == map )
+    {
+        return false;
+    }
+
+    const shared_dict_header_t* header = static_cast<const shared_dict_header_t*>( map );
+    bool valid = ( size >= sizeof(shared_dict_header_t) ) &&
+                 ( SHARED_DICT_MAGIC == header->magic ) && ( SHARED_DICT_VERSION == header->version ) &&
+                 ( generation == header->generation ) && ( size == header->size ) &&
+                 ( header->tables_offset + sizeof(dea_compiled_header_t) <= size );
+    if ( valid )
+    {
+        const dea_compiled_header_t* tables = reinterpret_cast<const dea_compiled_header_t*>(
+            static_cast<const uint8_t*>( map ) + header->tables_offset );
+        valid = ( DEA_COMPILED_MAGIC == tables->magic ) && ( DEA_COMPILED_VERSION == tables->version );
+    }
+    if ( !valid )
+    {
+        std::cout << "error attach " << m_name << ": invalid generation " << generation << std::endl;
+        munmap( map, size );
+        return false;
+    }
+
+    if ( nullptr != m_header )
+    {
+        munmap( const_cast<shared_dict_header_t*>( m_header ), m_header->size );
+    }
+    m_header = header;
+    return true;
+}
+
+
+/**************************************
+ *
+ *************************************/
+uint64_t SharedDict::generation() const
+{
+    return ( nullptr != m_header ) ? m_header->generation : 0;
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SharedDict::word_count() const
+{
+    return ( nullptr != m_header ) ? m_header->word_count : 0;
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SharedDict::min_word_length() const
+{
+    return ( nullptr != m_header ) ? m_header->min_word_length : 0;
+}
+
+/**************************************
+ *
+ *************************************/
+size_t SharedDict::size() const
+{
+    return ( nullptr != m_header ) ? m_header->size : 0;
+}
+
+/**************************************
+ *
+ *************************************/
+DeaTables SharedDict::tables() const
+{
+    if ( nullptr == m_header )
+    {
+        return DeaTables();
+    }
+    return DeaTables( reinterpret_cast<const uint8_t*>( m_header ) + m_header->tables_offset );
+}
+
+/**************************************
+ *
+ *************************************/
+std::string_view SharedDict::word( size_t index ) const
+{
+    const uint8_t*  base    = reinterpret_cast<const uint8_t*>( m_header );
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>( base + m_header->word_offsets_offset );
+    const char*     text    = reinterpret_cast<const char*>( base + m_header->word_chars_offset );
+
+    return std::string_view( text + offsets[index], offsets[index + 1] - offsets[index] );
+}
+
+}
@@ -0,0 +1,222 @@
+/*!*****************************************************************************
+ * @file table_memory.cpp
+ * @brief page and numa aware memory for the compiled dea tables
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "table_memory.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+namespace fastdict
+{
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/**************************************
+ *
+ *************************************/
+static size_t round_up( size_t size, size_t alignment )
+{
+    return ( ( size + alignment - 1 ) / alignment ) * alignment;
+}
+
+
+TableMemory::TableMemory() :
+    m_data( nullptr ),
+    m_size( 0 ),
+    m_mapped_size( 0 ),
+    m_pages( TABLE_PAGES_DEFAULT )
+{
+}
+
+TableMemory::~TableMemory()
+{
+    release();
+}
+
+TableMemory::TableMemory( TableMemory&& other ) :
+    m_data( other.m_data ),
+    m_size( other.m_size ),
+    m_mapped_size( other.m_mapped_size ),
+    m_pages( other.m_pages )
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_mapped_size = 0;
+}
+
+TableMemory& TableMemory::operator=( TableMemory&& other )
+{
+    if ( this != &other )
+    {
+        release();
+        m_data        = other.m_data;
+        m_size        = other.m_size;
+        m_mapped_size = other.m_mapped_size;
+        m_pages       = other.m_pages;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_mapped_size = 0;
+    }
+    return *this;
+}
+
+
+/**************************************
+ *
+ *************************************/
+bool TableMemory::allocate( size_t size, table_page_mode_t pages, int numa_node )
+{
+    release();
+    if ( 0 == size )
+    {
+        return true;
+    }
+
+    void* mapping = MAP_FAILED;
+    size_t mapped_size = 0;
+
+    if ( TABLE_PAGES_EXPLICIT_HUGE == pages )
+    {
+        mapped_size = round_up( size, HUGE_PAGE_SIZE );
+        mapping = mmap( nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+        if ( MAP_FAILED == mapping )
+        {
+            std::cout << "no explicit huge pages available, using transparent huge pages" << std::endl;
+            pages = TABLE_PAGES_TRANSPARENT_HUGE;
+        }
+    }
+
+    if ( TABLE_PAGES_TRANSPARENT_HUGE == pages )
+    {
+        // over allocate so the table can start on a huge page boundary
+        mapped_size = round_up( size, HUGE_PAGE_SIZE );
+        size_t reserve = mapped_size + HUGE_PAGE_SIZE;
+        mapping = mmap( nullptr, reserve, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( MAP_FAILED != mapping )
+        {
+            uintptr_t begin   = reinterpret_cast<uintptr_t>( mapping );
+            uintptr_t aligned = round_up( begin, HUGE_PAGE_SIZE );
+            if ( aligned > begin )
+            {
+                munmap( mapping, aligned - begin );
+            }
+            if ( ( begin + reserve ) > ( aligned + mapped_size ) )
+            {
+                munmap( reinterpret_cast<void*>( aligned + mapped_size ), ( begin + reserve ) - ( aligned + mapped_size ) );
+            }
+            mapping = reinterpret_cast<void*>( aligned );
+            madvise( mapping, mapped_size, MADV_HUGEPAGE );
+        }
+    }
+    else if ( TABLE_PAGES_DEFAULT == pages )
+    {
+        mapped_size = round_up( size, static_cast<size_t>( sysconf( _SC_PAGE_SIZE ) ) );
+        mapping = mmap( nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    }
+
+    if ( MAP_FAILED == mapping )
+    {
+        std::cout << "error mapping " << size << " bytes of table memory" << std::endl;
+        return false;
+    }
+
+    if ( numa_node >= 0 )
+    {
+        // bind before the first touch so every page is faulted in on the node
+        unsigned long node_mask = 1UL << numa_node;
+        if ( 0 != syscall( SYS_mbind, mapping, mapped_size, MPOL_BIND, &node_mask, sizeof(node_mask) * 8, 0 ) )
+        {
+            std::cout << "error binding table memory to numa node " << numa_node << std::endl;
+        }
+    }
+
+    m_data        = static_cast<uint8_t*>( mapping );
+    m_size        = size;
+    m_mapped_size = mapped_size;
+    m_pages       = pages;
+
+    return true;
+}
+
+
+/**************************************
+ *
+ *************************************/
+void TableMemory::release()
+{
+    if ( nullptr != m_data )
+    {
+        munmap( m_data, m_mapped_size );
+    }
+    m_data        = nullptr;
+    m_size        = 0;
+    m_mapped_size = 0;
+}
+
+
+/**************************************
+ *
+ *************************************/
+size_t TableMemory::numa_node_count()
+{
+    size_t result = 1;
+
+    // format is a cpu list like "0" or "0-1"
+    std::ifstream online( "/sys/devices/system/node/online" );
+    std::string nodes;
+    if ( std::getline( online, nodes ) && !nodes.empty() )
+    {
+        size_t last = nodes.find_last_of( "-," );
+        std::string highest = ( std::string::npos == last ) ? nodes : nodes.substr( last + 1 );
+        result = std::stoul( highest ) + 1;
+    }
+
+    return result;
+}
+
+
+/**************************************
+ *
+ *************************************/
+int TableMemory::current_numa_node()
+{
+    unsigned int cpu  = 0;
+    unsigned int node = 0;
+
+    if ( 0 != getcpu( &cpu, &node ) )
+    {
+        return 0;
+    }
+
+    return static_cast<int>( node );
+}
+
+}
@@ -0,0 +1,98 @@
+/*!*****************************************************************************
+ * @file async_scan.cpp
+ * @brief scans a large payload in time slices next to other work
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#include <fastdict.h>
+#include <dea_scan_task.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/******************************************************************************
+ * a toy event loop: one connection delivers a 4MB payload that is scanned
+ * in slices, other connections would get a turn after every slice
+ *****************************************************************************/
+int main( int argc, char** argv )
+{
+    std::string list        = ( argc > 1 ) ? argv[1] : "xxl_list_unique_sorted.txt";
+    size_t      slice_bytes = ( argc > 2 ) ? std::stoul( argv[2] ) : 64 * 1024;
+
+    fastdict::FastDict dict;
+    dict.load_from_list( list );
+    const std::vector<std::string>& words = dict;
+    if ( words.empty() )
+    {
+        return 1;
+    }
+
+    std::mt19937 rng( 11 );
+    std::string payload;
+    while ( payload.length() < ( 4u << 20 ) )
+    {
+        payload += words[rng() % words.size()];
+        payload.push_back( ' ' );
+    }
+
+    fastdict::DeaScanner   scanner = dict.make_scanner();
+    fastdict::DeaMatchSink sink( 1024 );
+    fastdict::DeaScanTask  task = fastdict::scan_in_slices( scanner,
+        reinterpret_cast<const uint8_t*>( payload.data() ), payload.length(), sink, slice_bytes );
+
+    std::vector<size_t> found;
+    size_t    turns = 0;
+    size_t    sink_full = 0;
+    long long longest_ns = 0;
+    while ( !task.done() )
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if ( fastdict::DEA_SCAN_SINK_FULL == task.step() )
+        {
+            sink_full++;
+        }
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+        longest_ns = std::max( longest_ns, ns );
+
+        // the consumer drains what fits, a full sink suspends the scan
+        fastdict::dea_match_t match;
+        while ( sink.pop( match ) )
+        {
+            found.push_back( match.word_index );
+        }
+        turns++;
+    }
+
+    std::sort( found.begin(), found.end() );
+    found.erase( std::unique( found.begin(), found.end() ), found.end() );
+    size_t expected = dict.get_contained_words( payload ).size();
+
+    std::cout << "scanned " << payload.length() << " bytes in " << turns << " turns, "
+              << sink_full << " stopped by a full sink, longest turn "
+              << longest_ns / 1000 << "us" << std::endl;
+    std::cout << found.size() << " distinct words, get_contained_words found " << expected << std::endl;
+
+    return ( found.size() == expected ) ? 0 : 1;
+}
@@ -0,0 +1,709 @@
+/*!*****************************************************************************
+ * @file bench.cpp
+ * @brief benchmark modes for libfastdict
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#include <fastdict.h>
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+
+
+/******************************************************************************
+ * hardware event counter of the process and all threads started later,
+ * reads -1 if perf events are not available
+ *****************************************************************************/
+class PerfCounter
+{
+public:
+    PerfCounter( uint32_t type, uint64_t config ) :
+        m_fd( -1 )
+    {
+        struct perf_event_attr attr;
+        memset( &attr, 0, sizeof(attr) );
+        attr.size           = sizeof(attr);
+        attr.type           = type;
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.inherit        = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        m_fd = static_cast<int>( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+    }
+
+    ~PerfCounter()
+    {
+        if ( m_fd >= 0 )
+            close( m_fd );
+    }
+
+    static PerfCounter dtlb_load_misses()
+    {
+        return PerfCounter( PERF_TYPE_HW_CACHE,
+                            PERF_COUNT_HW_CACHE_DTLB
+                            | ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+                            | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) );
+    }
+
+    static PerfCounter cache_misses()
+    {
+        return PerfCounter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES );
+    }
+
+    PerfCounter( PerfCounter&& other ) : m_fd( other.m_fd ) { other.m_fd = -1; }
+
+    void start()
+    {
+        if ( m_fd >= 0 )
+        {
+            ioctl( m_fd, PERF_EVENT_IOC_RESET, 0 );
+            ioctl( m_fd, PERF_EVENT_IOC_ENABLE, 0 );
+        }
+    }
+
+    long long stop()
+    {
+        long long count = -1;
+        if ( m_fd >= 0 )
+        {
+            ioctl( m_fd, PERF_EVENT_IOC_DISABLE, 0 );
+            if ( sizeof(count) != read( m_fd, &count, sizeof(count) ) )
+                count = -1;
+        }
+        return count;
+    }
+
+private:
+    int m_fd;
+};
+
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+static long long elapsed_ns( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+}
+
+
+/******************************************************************************
+ * short queries as seen in production: a dictionary word surrounded by
+ * a few random letters, every fourth query has no word at all
+ *****************************************************************************/
+static std::vector<std::string> make_queries( const std::vector<std::string>& words, size_t count )
+{
+    std::vector<std::string> queries;
+    std::mt19937 rng( 42 );
+
+    for ( size_t q_idx = 0; q_idx < count; q_idx++ )
+    {
+        std::string query;
+        size_t pad = rng() % 6;
+        for ( size_t i = 0; i < pad; i++ )
+            query.push_back( static_cast<char>( 'a' + rng() % 26 ) );
+        if ( ( 0 != ( q_idx % 4 ) ) && !words.empty() )
+            query += words[rng() % words.size()];
+        else
+            for ( size_t i = 0; i < 12; i++ )
+                query.push_back( static_cast<char>( '0' + rng() % 10 ) );
+        for ( size_t i = 0; i < pad; i++ )
+            query.push_back( static_cast<char>( 'a' + rng() % 26 ) );
+        queries.push_back( query );
+    }
+
+    return queries;
+}
+
+
+/******************************************************************************
+ * runs all queries split over the given number of threads, returns the
+ * number of reported words
+ *****************************************************************************/
+static size_t run_queries( fastdict::FastDict& dict, const std::vector<std::string>& queries, size_t threads )
+{
+    std::vector<size_t> found( threads, 0 );
+    std::vector<std::thread> workers;
+
+    for ( size_t t_idx = 0; t_idx < threads; t_idx++ )
+    {
+        workers.push_back( std::thread( [&dict, &queries, &found, t_idx, threads]()
+        {
+            for ( size_t q_idx = t_idx; q_idx < queries.size(); q_idx += threads )
+            {
+                found[t_idx] += dict.get_contained_words( queries[q_idx] ).size();
+            }
+        } ) );
+    }
+
+    size_t result = 0;
+    for ( size_t t_idx = 0; t_idx < threads; t_idx++ )
+    {
+        workers[t_idx].join();
+        result += found[t_idx];
+    }
+    return result;
+}
+
+
+/******************************************************************************
+ * scans every query to the end without collecting words: no word carries
+ * the requested category. returns the number of matching queries.
+ *****************************************************************************/
+static size_t scan_queries( fastdict::FastDict& dict, const std::vector<std::string>& queries )
+{
+    const fastdict::dea_mask_t unused_category = ~fastdict::DEA_DEFAULT_CATEGORY;
+    size_t result = 0;
+
+    for ( const std::string& query : queries )
+    {
+        if ( 0 != dict.get_contained_categories( query, unused_category ) )
+            result++;
+    }
+    return result;
+}
+
+
+/******************************************************************************
+ * throughput and dTLB misses for every table placement
+ *****************************************************************************/
+static int bench_tlb( fastdict::FastDict& dict, size_t threads )
+{
+    struct placement_t
+    {
+        const char*                 name;
+        fastdict::table_page_mode_t pages;
+        bool                        numa;
+    };
+    const placement_t placements[] = {
+        { "default",      fastdict::TABLE_PAGES_DEFAULT,          false },
+        { "transparent",  fastdict::TABLE_PAGES_TRANSPARENT_HUGE, false },
+        { "explicit",     fastdict::TABLE_PAGES_EXPLICIT_HUGE,    false },
+        { "default",      fastdict::TABLE_PAGES_DEFAULT,          true  },
+        { "transparent",  fastdict::TABLE_PAGES_TRANSPARENT_HUGE, true  },
+        { "explicit",     fastdict::TABLE_PAGES_EXPLICIT_HUGE,    true  },
+    };
+
+    const std::vector<std::string>& words = dict;
+    std::vector<std::string> queries = make_queries( words, 500000 );
+
+    std::cout << "tables " << dict.table_size() / 1024 << " KB, "
+              << fastdict::TableMemory::numa_node_count() << " numa node(s), "
+              << threads << " thread(s)" << std::endl;
+    printf( "%-12s %-5s %14s %14s %16s\n", "pages", "numa", "queries/s", "ns/query", "dTLB misses" );
+
+    for ( const placement_t& p : placements )
+    {
+        dict.set_table_placement( p.pages, p.numa );
+
+        // warm up so page faults are not part of the measurement
+        run_queries( dict, queries, threads );
+
+        PerfCounter dtlb = PerfCounter::dtlb_load_misses();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        dtlb.start();
+        run_queries( dict, queries, threads );
+        long long misses = dtlb.stop();
+        long long ns = elapsed_ns( start );
+
+        printf( "%-12s %-5s %14.0f %14.1f %16s\n", p.name, p.numa ? "yes" : "no",
+                static_cast<double>( queries.size() ) * 1e9 / static_cast<double>( ns ),
+                static_cast<double>( ns ) / static_cast<double>( queries.size() ),
+                ( misses < 0 ) ? "n/a" : std::to_string( misses ).c_str() );
+    }
+
+    dict.set_table_placement( fastdict::TABLE_PAGES_DEFAULT, false );
+    return 0;
+}
+
+
+/******************************************************************************
+ * cache misses and throughput per state layout. the profile layout is
+ * trained on a different query set than the one that is measured.
+ *****************************************************************************/
+static int bench_layout( fastdict::FastDict& dict )
+{
+    struct layout_t
+    {
+        const char*           name;
+        fastdict::dea_layout_t layout;
+    };
+    const layout_t layouts[] = {
+        { "insertion", fastdict::DEA_LAYOUT_INSERTION },
+        { "bfs+dfs",   fastdict::DEA_LAYOUT_BFS },
+        { "profile",   fastdict::DEA_LAYOUT_PROFILE },
+    };
+
+    const std::vector<std::string>& words = dict;
+    std::vector<std::string> training = make_queries( words, 200000 );
+    std::vector<std::string> queries  = make_queries( std::vector<std::string>( words.rbegin(), words.rend() ), 500000 );
+
+    std::vector<uint64_t> visits;
+    for ( const std::string& query : training )
+    {
+        dict.record_state_visits( query, visits );
+    }
+    dict.save_state_profile( "bench_profile.txt", visits );
+
+    printf( "%-10s %14s %14s %16s %16s\n", "layout", "queries/s", "ns/query", "cache misses", "dTLB misses" );
+
+    for ( const layout_t& l : layouts )
+    {
+        if ( fastdict::DEA_LAYOUT_PROFILE == l.layout )
+            dict.load_state_profile( "bench_profile.txt" );
+        else
+            dict.set_state_layout( l.layout );
+
+        scan_queries( dict, queries );
+
+        PerfCounter cache = PerfCounter::cache_misses();
+        PerfCounter dtlb  = PerfCounter::dtlb_load_misses();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        cache.start();
+        dtlb.start();
+        scan_queries( dict, queries );
+        long long tlb_misses   = dtlb.stop();
+        long long cache_misses = cache.stop();
+        long long ns = elapsed_ns( start );
+
+        printf( "%-10s %14.0f %14.1f %16s %16s\n", l.name,
+                static_cast<double>( queries.size() ) * 1e9 / static_cast<double>( ns ),
+                static_cast<double>( ns ) / static_cast<double>( queries.size() ),
+                ( cache_misses < 0 ) ? "n/a" : std::to_string( cache_misses ).c_str(),
+                ( tlb_misses < 0 ) ? "n/a" : std::to_string( tlb_misses ).c_str() );
+    }
+
+    unlink( "bench_profile.txt" );
+    dict.set_state_layout( fastdict::DEA_LAYOUT_INSERTION );
+    return 0;
+}
+
+
+/******************************************************************************
+ * memory and query time of the succinct backend against the automaton
+ *****************************************************************************/
+static int bench_succinct( fastdict::FastDict& dict, const std::string& list )
+{
+    fastdict::FastDict succinct;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    succinct.load_from_list( list, fastdict::FastDict::eNone, fastdict::FastDict::eSuccinct );
+    long long load_ns = elapsed_ns( start );
+    std::cout << "succinct loaded " << succinct.size() << " words in " << load_ns / 1000000 << "ms" << std::endl;
+
+    const std::vector<std::string>& words = dict;
+    std::vector<std::string> queries = make_queries( words, 200000 );
+
+    // the automaton backend also keeps every word as std::string
+    size_t word_bytes = 0;
+    for ( const std::string& w : words )
+    {
+        word_bytes += sizeof(std::string) + ( ( w.capacity() > 15 ) ? w.capacity() + 1 : 0 );
+    }
+
+    printf( "%-10s %14s %12s %18s %18s\n", "backend", "bytes", "bytes/word", "ns/contained", "ns/contains_word" );
+
+    fastdict::FastDict* backends[] = { &dict, &succinct };
+    double contained_ns[2];
+    double lookup_ns[2];
+    for ( size_t b_idx = 0; b_idx < 2; b_idx++ )
+    {
+        fastdict::FastDict& d = *backends[b_idx];
+        size_t bytes = d.table_size() + ( ( 0 == b_idx ) ? word_bytes : 0 );
+
+        start = std::chrono::steady_clock::now();
+        run_queries( d, queries, 1 );
+        contained_ns[b_idx] = static_cast<double>( elapsed_ns( start ) ) / static_cast<double>( queries.size() );
+
+        size_t found = 0;
+        start = std::chrono::steady_clock::now();
+        for ( size_t w_idx = 0; w_idx < words.size(); w_idx++ )
+        {
+            if ( d.contains_word( words[w_idx] ) )
+                found++;
+        }
+        lookup_ns[b_idx] = static_cast<double>( elapsed_ns( start ) ) / static_cast<double>( words.size() );
+
+        printf( "%-10s %14zu %12.1f %18.1f %18.1f\n", ( 0 == b_idx ) ? "automaton" : "succinct", bytes,
+                static_cast<double>( bytes ) / static_cast<double>( d.size() ), contained_ns[b_idx], lookup_ns[b_idx] );
+        if ( found != words.size() )
+            std::cout << "contains_word missed " << words.size() - found << " words" << std::endl;
+    }
+    printf( "slowdown: %.1fx contained words, %.1fx contains_word\n",
+            contained_ns[1] / contained_ns[0], lookup_ns[1] / lookup_ns[0] );
+
+    return 0;
+}
+
+
+/******************************************************************************
+ * load time of the sequential and the parallel build
+ *****************************************************************************/
+static int bench_build( fastdict::FastDict& dict, const std::string& list, size_t threads )
+{
+    const std::vector<std::string>& words = dict;
+    std::vector<std::string> queries = make_queries( words, 20000 );
+
+    printf( "%-10s %12s %14s %10s\n", "threads", "words", "bytes", "load ms" );
+
+    size_t counts[] = { 1, 2, threads, 0 };
+    for ( size_t count : counts )
+    {
+        fastdict::FastDict built;
+        built.set_build_threads( count );
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        built.load_from_list( list );
+        long long load_ns = elapsed_ns( start );
+
+        printf( "%-10s %12zu %14zu %10lld\n", ( 0 == count ) ? "per cpu" : std::to_string( count ).c_str(),
+                built.size(), built.table_size(), load_ns / 1000000 );
+
+        for ( const std::string& q : queries )
+        {
+            if ( built.get_contained_words( q ) != dict.get_contained_words( q ) )
+            {
+                std::cout << "result differs from the sequential build for " << q << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************
+ * sequential against interleaved scans of one long input, on tables built
+ * from growing parts of the word list
+ *****************************************************************************/
+static int bench_lanes( fastdict::FastDict& dict )
+{
+    const std::vector<std::string>& words = dict;
+
+    // 4MB of words separated by a few random letters
+    std::mt19937 rng( 7 );
+    std::string text;
+    while ( text.length() < ( 4u << 20 ) )
+    {
+        text += words[rng() % words.size()];
+        for ( size_t i = rng() % 4; i > 0; i-- )
+            text.push_back( static_cast<char>( 'a' + rng() % 26 ) );
+    }
+    const uint8_t* input = reinterpret_cast<const uint8_t*>( text.data() );
+
+    printf( "%-10s %14s %12s %8s %12s %8s\n", "words", "bytes", "lanes", "MB/s", "speedup", "ok" );
+
+    for ( size_t count = 1000; ; count *= 10 )
+    {
+        count = std::min( count, words.size() );
+        std::vector<std::string> part;
+        for ( size_t w_idx = 0; w_idx < count; w_idx++ )
+            part.push_back( words[( w_idx * 7919 ) % words.size()] );
+        std::vector<fastdict::dea_mask_t> masks( part.size(), fastdict::DEA_DEFAULT_CATEGORY );
+
+        fastdict::DeaCompiled compiled;
+        compiled.compile_parallel( part, masks, 1 );
+        fastdict::DeaTables tables = compiled.tables();
+
+        std::vector<ssize_t> expected;
+        double sequential_ns = 0;
+        size_t lane_counts[] = { 1, 2, 4, 8 };
+        for ( size_t lanes : lane_counts )
+        {
+            std::vector<ssize_t> result;
+            result.reserve( text.length() / 4 );
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if ( 1 == lanes )
+                tables.find_all( input, text.length(), fastdict::DEA_ALL_CATEGORIES, result );
+            else
+                tables.find_all_interleaved( input, text.length(), fastdict::DEA_ALL_CATEGORIES, lanes, result );
+            double ns = static_cast<double>( elapsed_ns( start ) );
+
+            std::sort( result.begin(), result.end() );
+            if ( 1 == lanes )
+            {
+                expected = result;
+                sequential_ns = ns;
+            }
+            printf( "%-10zu %14zu %12zu %8.1f %11.2fx %8s\n", part.size(), compiled.table_size(), lanes,
+                    static_cast<double>( text.length() ) * 1000.0 / ns, sequential_ns / ns,
+                    ( result == expected ) ? "yes" : "NO" );
+        }
+
+        if ( count == words.size() )
+            break;
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************
+ * rejection and false positive rate of the q-gram prefilter and the query
+ * time with and without it, per kind of input
+ *****************************************************************************/
+static int bench_prefilter( fastdict::FastDict& dict )
+{
+    const std::vector<std::string>& words = dict;
+    std::mt19937 rng( 13 );
+
+    // tokens like ids or product codes, lower case letters and digits
+    std::vector<std::string> tokens;
+    const char alnum[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    for ( size_t q_idx = 0; q_idx < 200000; q_idx++ )
+    {
+        std::string token;
+        for ( size_t i = 6 + rng() % 9; i > 0; i-- )
+            token.push_back( alnum[rng() % 36] );
+        tokens.push_back( token );
+    }
+
+    // upper case hex codes, no word of the list is upper case
+    std::vector<std::string> codes;
+    for ( size_t q_idx = 0; q_idx < 200000; q_idx++ )
+    {
+        std::string code;
+        for ( size_t i = 8 + rng() % 9; i > 0; i-- )
+            code.push_back( "0123456789ABCDEF"[rng() % 16] );
+        codes.push_back( code );
+    }
+
+    struct input_set_t
+    {
+        const char*                     name;
+        const std::vector<std::string>* queries;
+    };
+    std::vector<std::string> mixed = make_queries( words, 200000 );
+    input_set_t sets[] = { { "queries", &mixed }, { "tokens", &tokens }, { "codes", &codes } };
+
+    printf( "%-8s %3s %10s %10s %10s %10s %10s %9s\n", "input", "q", "no match", "rejected", "false pos",
+            "ns plain", "ns filter", "speedup" );
+
+    size_t q_values[] = { 2, 3 };
+    for ( const input_set_t& set : sets )
+    {
+        const std::vector<std::string>& queries = *set.queries;
+
+        dict.set_prefilter( 0 );
+        std::vector<bool> matches( queries.size() );
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for ( size_t q_idx = 0; q_idx < queries.size(); q_idx++ )
+            matches[q_idx] = !dict.get_contained_words( queries[q_idx] ).empty();
+        double plain_ns = static_cast<double>( elapsed_ns( start ) ) / static_cast<double>( queries.size() );
+
+        for ( size_t q : q_values )
+        {
+            dict.set_prefilter( q );
+            const fastdict::QGramFilter& filter = dict.prefilter();
+
+            size_t no_match = 0, rejected = 0, false_pos = 0, lost = 0;
+            for ( size_t q_idx = 0; q_idx < queries.size(); q_idx++ )
+            {
+                bool pass = filter.may_match( reinterpret_cast<const uint8_t*>( queries[q_idx].data() ), queries[q_idx].length() );
+                no_match  += matches[q_idx] ? 0 : 1;
+                rejected  += pass ? 0 : 1;
+                false_pos += ( pass && !matches[q_idx] ) ? 1 : 0;
+                lost      += ( !pass && matches[q_idx] ) ? 1 : 0;
+            }
+
+            size_t found = 0;
+            start = std::chrono::steady_clock::now();
+            for ( size_t q_idx = 0; q_idx < queries.size(); q_idx++ )
+                found += dict.get_contained_words( queries[q_idx] ).empty() ? 0 : 1;
+            double filter_ns = static_cast<double>( elapsed_ns( start ) ) / static_cast<double>( queries.size() );
+
+            printf( "%-8s %3zu %9.1f%% %9.1f%% %9.1f%% %10.1f %10.1f %8.2fx\n", set.name, filter.q(),
+                    100.0 * no_match / queries.size(), 100.0 * rejected / queries.size(),
+                    ( 0 == no_match ) ? 0.0 : 100.0 * false_pos / no_match,
+                    plain_ns, filter_ns, plain_ns / filter_ns );
+            if ( 0 != lost )
+                std::cout << "the filter rejected " << lost << " matching inputs" << std::endl;
+        }
+    }
+    dict.set_prefilter( 0 );
+
+    return 0;
+}
+
+
+/******************************************************************************
+ * uniform against hybrid row encoding of the same tables: scans of a long
+ * text and of short queries, which mostly step through dense shallow rows
+ * and failure links, and trie walks of whole words, which mostly follow
+ * chains
+ *****************************************************************************/
+static int bench_encoding( fastdict::FastDict& dict )
+{
+    const std::vector<std::string>& words = dict;
+
+    std::mt19937 rng( 11 );
+    std::string text;
+    while ( text.length() < ( 4u << 20 ) )
+    {
+        text += words[rng() % words.size()];
+        for ( size_t i = rng() % 4; i > 0; i-- )
+            text.push_back( static_cast<char>( 'a' + rng() % 26 ) );
+    }
+    std::vector<std::string> queries = make_queries( words, 200000 );
+    std::vector<std::string> lookups;
+    for ( size_t l_idx = 0; l_idx < 200000; l_idx++ )
+    {
+        lookups.push_back( words[rng() % words.size()] );
+        if ( 0 == ( l_idx % 2 ) )
+            lookups.back().push_back( 'q' );
+    }
+
+    printf( "%-10s %-8s %10s %10s %12s %12s %12s %6s\n", "words", "encoding", "bytes", "scan MB/s",
+            "query ns", "lookup ns", "prefix ns", "ok" );
+
+    for ( size_t count = 1000; ; count *= 10 )
+    {
+        count = std::min( count, words.size() );
+        std::vector<std::string> part;
+        for ( size_t w_idx = 0; w_idx < count; w_idx++ )
+            part.push_back( words[( w_idx * 7919 ) % words.size()] );
+        std::vector<fastdict::dea_mask_t> masks( part.size(), fastdict::DEA_DEFAULT_CATEGORY );
+
+        fastdict::DeaCompiled compiled;
+        compiled.compile_parallel( part, masks, 1 );
+
+        size_t expected = 0;
+        fastdict::dea_encoding_t encodings[] = { fastdict::DEA_ENCODING_UNIFORM, fastdict::DEA_ENCODING_HYBRID };
+        for ( fastdict::dea_encoding_t encoding : encodings )
+        {
+            compiled.set_encoding( encoding );
+            fastdict::DeaTables tables = compiled.tables();
+            size_t checksum = 0;
+
+            std::vector<ssize_t> result;
+            result.reserve( text.length() / 4 );
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            tables.find_all( reinterpret_cast<const uint8_t*>( text.data() ), text.length(), fastdict::DEA_ALL_CATEGORIES, result );
+            double scan_ns = static_cast<double>( elapsed_ns( start ) );
+            checksum += result.size();
+
+            start = std::chrono::steady_clock::now();
+            for ( const std::string& q : queries )
+                checksum += static_cast<size_t>( tables.find_first( reinterpret_cast<const uint8_t*>( q.data() ), q.length(), fastdict::DEA_ALL_CATEGORIES ) + 1 );
+            double query_ns = static_cast<double>( elapsed_ns( start ) ) / static_cast<double>( queries.size() );
+
+            start = std::chrono::steady_clock::now();
+            for ( const std::string& l : lookups )
+                checksum += static_cast<size_t>( tables.lookup( reinterpret_cast<const uint8_t*>( l.data() ), l.length() ) + 1 );
+            double lookup_ns = static_cast<double>( elapsed_ns( start ) ) / static_cast<double>( lookups.size() );
+
+            start = std::chrono::steady_clock::now();
+            for ( const std::string& l : lookups )
+            {
+                result.clear();
+                tables.find_prefixes( reinterpret_cast<const uint8_t*>( l.data() ), l.length(), false,
+                                      fastdict::DEA_ALL_CATEGORIES, false, result );
+                checksum += result.size();
+            }
+            double prefix_ns = static_cast<double>( elapsed_ns( start ) ) / static_cast<double>( lookups.size() );
+
+            if ( fastdict::DEA_ENCODING_UNIFORM == encoding )
+                expected = checksum;
+            printf( "%-10zu %-8s %10zu %10.1f %12.1f %12.1f %12.1f %6s\n", part.size(),
+                    ( fastdict::DEA_ENCODING_UNIFORM == encoding ) ? "uniform" : "hybrid", compiled.table_size(),
+                    static_cast<double>( text.length() ) * 1000.0 / scan_ns, query_ns, lookup_ns, prefix_ns,
+                    ( checksum == expected ) ? "yes" : "NO" );
+        }
+
+        fastdict::dea_encoding_stats_t stats = compiled.tables().encoding_stats();
+        printf( "%-10s leaf %zu, single %zu, in chains %zu, sparse %zu, dense %zu (%zu bytes), binary %zu\n", "",
+                stats.leaf_states, stats.single_states, stats.chain_states, stats.sparse_states,
+                stats.dense_states, stats.dense_bytes, stats.binary_states );
+
+        if ( count == words.size() )
+            break;
+    }
+
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+static void usage()
+{
+    std::cout << "usage: bench <mode> [word list] [threads]\n"
+              << "modes:\n"
+              << "  tlb     throughput and dTLB misses per table placement\n"
+              << "  layout  throughput and cache misses per state layout\n"
+              << "  succinct memory and query time of the succinct backend\n"
+              << "  build   load time of the parallel build per thread count\n"
+              << "  lanes   sequential against interleaved scans per dictionary size\n"
+              << "  prefilter rejection rate and speedup of the q-gram prefilter\n"
+              << "  encoding uniform against hybrid row encoding per dictionary size\n";
+}
+
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+int main( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        usage();
+        return 1;
+    }
+
+    std::string mode    = argv[1];
+    std::string list    = ( argc > 2 ) ? argv[2] : "xxl_list_unique_sorted.txt";
+    size_t      threads = ( argc > 3 ) ? std::stoul( argv[3] ) : 1;
+    if ( 0 == threads )
+        threads = 1;
+
+    fastdict::FastDict dict;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    dict.load_from_list( list );
+    std::cout << "loaded " << dict.size() << " words in " << elapsed_ns( start ) / 1000000 << "ms" << std::endl;
+
+    if ( "tlb" == mode )
+        return bench_tlb( dict, threads );
+    if ( "layout" == mode )
+        return bench_layout( dict );
+    if ( "succinct" == mode )
+        return bench_succinct( dict, list );
+    if ( "prefilter" == mode )
+        return bench_prefilter( dict );
+    if ( "lanes" == mode )
+        return bench_lanes( dict );
+    if ( "build" == mode )
+        return bench_build( dict, list, threads );
+    if ( "encoding" == mode )
+        return bench_encoding( dict );
+
+    usage();
+    return 1;
+}
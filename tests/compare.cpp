@@ -0,0 +1,398 @@
+/*!*****************************************************************************
+ * @file compare.cpp
+ * @brief fastdict against simple baseline matchers on the same inputs
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#include <fastdict.h>
+
+#include <unistd.h>
+#include <malloc.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+
+typedef std::vector<std::string> match_set_t;
+
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+static long long elapsed_ns( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+}
+
+/******************************************************************************
+ * bytes allocated on the heap, the compiled tables are mapped separately
+ *****************************************************************************/
+static size_t heap_in_use()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+
+/******************************************************************************
+ * the engines compared, each returns the sorted distinct words an input
+ * contains
+ *****************************************************************************/
+class Engine
+{
+public:
+    virtual ~Engine() {}
+    virtual const char* name() const = 0;
+    virtual void load( const std::vector<std::string>& words ) = 0;
+    virtual match_set_t find( const std::string& input ) = 0;
+    virtual bool complete() const { return true; }
+};
+
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+class FastDictEngine : public Engine
+{
+public:
+    explicit FastDictEngine( const std::string& list ) : m_list( list ) {}
+    const char* name() const override { return "fastdict"; }
+    void load( const std::vector<std::string>& ) override { m_dict.load_from_list( m_list ); }
+    match_set_t find( const std::string& input ) override
+    {
+        match_set_t result = m_dict.get_contained_words( input );
+        std::sort( result.begin(), result.end() );
+        result.erase( std::unique( result.begin(), result.end() ), result.end() );
+        return result;
+    }
+    size_t table_size() const { return m_dict.table_size(); }
+
+private:
+    std::string        m_list;
+    fastdict::FastDict m_dict;
+};
+
+
+/******************************************************************************
+ * std::string::find for every word
+ *****************************************************************************/
+class NaiveEngine : public Engine
+{
+public:
+    const char* name() const override { return "naive find"; }
+    void load( const std::vector<std::string>& words ) override { m_words = words; }
+    match_set_t find( const std::string& input ) override
+    {
+        match_set_t result;
+        for ( const std::string& w : m_words )
+        {
+            if ( std::string::npos != input.find( w ) )
+                result.push_back( w );
+        }
+        std::sort( result.begin(), result.end() );
+        return result;
+    }
+
+private:
+    std::vector<std::string> m_words;
+};
+
+
+/******************************************************************************
+ * every substring between the shortest and the longest word length is
+ * looked up in a hash set
+ *****************************************************************************/
+class WindowEngine : public Engine
+{
+public:
+    const char* name() const override { return "hash window"; }
+    void load( const std::vector<std::string>& words ) override
+    {
+        m_words = words;
+        m_min = ~size_t( 0 );
+        m_max = 0;
+        for ( const std::string& w : m_words )
+        {
+            m_set.insert( w );
+            m_min = std::min( m_min, w.length() );
+            m_max = std::max( m_max, w.length() );
+        }
+    }
+    match_set_t find( const std::string& input ) override
+    {
+        match_set_t result;
+        std::string_view in( input );
+        for ( size_t start = 0; start + m_min <= in.length(); start++ )
+        {
+            size_t longest = std::min( m_max, in.length() - start );
+            for ( size_t len = m_min; len <= longest; len++ )
+            {
+                std::unordered_set<std::string_view>::iterator it = m_set.find( in.substr( start, len ) );
+                if ( m_set.end() != it )
+                    result.push_back( std::string( *it ) );
+            }
+        }
+        std::sort( result.begin(), result.end() );
+        result.erase( std::unique( result.begin(), result.end() ), result.end() );
+        return result;
+    }
+
+private:
+    std::vector<std::string>                     m_words;
+    std::unordered_set<std::string_view>         m_set;
+    size_t                                       m_min = 0;
+    size_t                                       m_max = 0;
+};
+
+
+/******************************************************************************
+ * std::regex alternation of all words. regex_search reports one
+ * alternative per position, so this engine only answers whether an input
+ * contains any word; its match set is the first match or empty.
+ *****************************************************************************/
+class RegexEngine : public Engine
+{
+public:
+    const char* name() const override { return "std::regex"; }
+    bool complete() const override { return false; }
+    void load( const std::vector<std::string>& words ) override
+    {
+        std::string pattern;
+        for ( const std::string& w : words )
+        {
+            if ( !pattern.empty() )
+                pattern.push_back( '|' );
+            for ( char c : w )
+            {
+                if ( std::string::npos != std::string( "\\^$.|?*+()[]{}" ).find( c ) )
+                    pattern.push_back( '\\' );
+                pattern.push_back( c );
+            }
+        }
+        m_regex = std::regex( pattern, std::regex::optimize );
+    }
+    match_set_t find( const std::string& input ) override
+    {
+        std::smatch match;
+        if ( std::regex_search( input, match, m_regex ) )
+            return match_set_t( 1, match.str() );
+        return match_set_t();
+    }
+
+private:
+    std::regex m_regex;
+};
+
+
+/******************************************************************************
+ * short queries: a word between random letters, every fourth without one
+ *****************************************************************************/
+static std::vector<std::string> make_queries( const std::vector<std::string>& words, size_t count, unsigned seed )
+{
+    std::vector<std::string> queries;
+    std::mt19937 rng( seed );
+
+    for ( size_t q_idx = 0; q_idx < count; q_idx++ )
+    {
+        std::string query;
+        size_t pad = rng() % 6;
+        for ( size_t i = 0; i < pad; i++ )
+            query.push_back( static_cast<char>( 'a' + rng() % 26 ) );
+        if ( 0 != ( q_idx % 4 ) )
+            query += words[rng() % words.size()];
+        else
+            for ( size_t i = 0; i < 12; i++ )
+                query.push_back( static_cast<char>( '0' + rng() % 10 ) );
+        for ( size_t i = 0; i < pad; i++ )
+            query.push_back( static_cast<char>( 'a' + rng() % 26 ) );
+        queries.push_back( query );
+    }
+    return queries;
+}
+
+/******************************************************************************
+ * lines of about 1KB of words separated by blanks
+ *****************************************************************************/
+static std::vector<std::string> make_lines( const std::vector<std::string>& words, size_t count, unsigned seed )
+{
+    std::vector<std::string> lines;
+    std::mt19937 rng( seed );
+
+    for ( size_t l_idx = 0; l_idx < count; l_idx++ )
+    {
+        std::string line;
+        while ( line.length() < 1024 )
+        {
+            line += words[rng() % words.size()];
+            line.push_back( ' ' );
+        }
+        lines.push_back( line );
+    }
+    return lines;
+}
+
+
+/******************************************************************************
+ * runs every engine on the corpus, the first engine is the reference. the
+ * slow engines only get the first sample inputs, engines without complete
+ * match sets are compared on whether an input matches at all.
+ *****************************************************************************/
+static bool compare( const char* corpus_name,
+                     const std::vector<std::string>& corpus,
+                     std::vector<Engine*>& engines,
+                     const std::vector<size_t>& samples )
+{
+    bool identical = true;
+    std::vector<match_set_t> reference;
+
+    for ( size_t e_idx = 0; e_idx < engines.size(); e_idx++ )
+    {
+        size_t count = std::min( samples[e_idx], corpus.size() );
+        size_t bytes = 0;
+        size_t found = 0;
+        std::vector<match_set_t> results( count );
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for ( size_t c_idx = 0; c_idx < count; c_idx++ )
+        {
+            results[c_idx] = engines[e_idx]->find( corpus[c_idx] );
+            bytes += corpus[c_idx].length();
+        }
+        double ns = static_cast<double>( elapsed_ns( start ) );
+
+        size_t differ = 0;
+        for ( size_t c_idx = 0; c_idx < count; c_idx++ )
+        {
+            found += results[c_idx].size();
+            if ( 0 == e_idx )
+                continue;
+            bool same = !engines[e_idx]->complete() ? ( results[c_idx].empty() == reference[c_idx].empty() )
+                                       : ( results[c_idx] == reference[c_idx] );
+            if ( !same )
+                differ++;
+        }
+        if ( 0 == e_idx )
+            reference = results;
+        identical = identical && ( 0 == differ );
+
+        printf( "%-8s %-12s %8zu %12.0f %10.2f %8zu %10s\n", corpus_name, engines[e_idx]->name(), count,
+                static_cast<double>( count ) * 1e9 / ns, static_cast<double>( bytes ) * 1e3 / ns, found,
+                ( 0 == e_idx ) ? "reference" : ( ( 0 == differ ) ? "identical" : std::to_string( differ ).c_str() ) );
+    }
+
+    return identical;
+}
+
+
+/******************************************************************************
+ *
+ *****************************************************************************/
+int main( int argc, char** argv )
+{
+    std::string list   = ( argc > 1 ) ? argv[1] : "xxl_list_unique_sorted.txt";
+    size_t      subset = ( argc > 2 ) ? std::stoul( argv[2] ) : 300;
+
+    std::vector<std::string> words;
+    std::ifstream file( list );
+    for ( std::string line; std::getline( file, line ); )
+    {
+        if ( !line.empty() )
+            words.push_back( line );
+    }
+    std::sort( words.begin(), words.end() );
+    words.erase( std::unique( words.begin(), words.end() ), words.end() );
+    if ( words.empty() )
+    {
+        std::cout << "error read file " << list << std::endl;
+        return 1;
+    }
+
+    // the regex only gets an evenly spread subset, written to a list file
+    // so fastdict loads it the same way
+    std::vector<std::string> small;
+    for ( size_t w_idx = 0; w_idx < subset; w_idx++ )
+        small.push_back( words[w_idx * words.size() / subset] );
+    std::string small_list = "/tmp/fastdict_compare_" + std::to_string( getpid() ) + ".txt";
+    {
+        std::ofstream out( small_list );
+        for ( const std::string& w : small )
+            out << w << "\n";
+    }
+
+    FastDictEngine fast( list );
+    NaiveEngine    naive;
+    WindowEngine   window;
+    FastDictEngine fast_small( small_list );
+    NaiveEngine    naive_small;
+    RegexEngine    regex_small;
+
+    struct load_t
+    {
+        Engine*                         engine;
+        const std::vector<std::string>* words;
+    };
+    load_t loads[] = { { &fast, &words }, { &naive, &words }, { &window, &words },
+                       { &fast_small, &small }, { &naive_small, &small }, { &regex_small, &small } };
+
+    printf( "%-12s %8s %10s %14s\n", "engine", "words", "load ms", "memory bytes" );
+    for ( load_t& l : loads )
+    {
+        size_t heap = heap_in_use();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        l.engine->load( *l.words );
+        long long ns = elapsed_ns( start );
+        size_t memory = heap_in_use() - heap;
+        if ( l.engine == &fast )
+            memory += fast.table_size();
+        if ( l.engine == &fast_small )
+            memory += fast_small.table_size();
+        printf( "%-12s %8zu %10.1f %14zu\n", l.engine->name(), l.words->size(), static_cast<double>( ns ) / 1e6, memory );
+    }
+    unlink( small_list.c_str() );
+
+    std::vector<std::string> queries = make_queries( words, 20000, 42 );
+    std::vector<std::string> lines   = make_lines( words, 200, 43 );
+    std::vector<std::string> small_queries = make_queries( small, 20000, 44 );
+
+    printf( "\n%-8s %-12s %8s %12s %10s %8s %10s\n", "corpus", "engine", "inputs", "inputs/s", "MB/s", "matches", "result" );
+
+    std::vector<Engine*> full_engines  = { &fast, &naive, &window };
+    std::vector<Engine*> small_engines = { &fast_small, &naive_small, &regex_small };
+    bool identical = true;
+
+    std::cout << "all " << words.size() << " words" << std::endl;
+    identical = compare( "queries", queries, full_engines, { queries.size(), 200, queries.size() } ) && identical;
+    identical = compare( "lines", lines, full_engines, { lines.size(), 5, lines.size() } ) && identical;
+
+    std::cout << small.size() << " words, regex only compared on whether an input matches" << std::endl;
+    identical = compare( "queries", small_queries, small_engines, { small_queries.size(), small_queries.size(), 2000 } ) && identical;
+    identical = compare( "lines", lines, small_engines, { lines.size(), lines.size(), 20 } ) && identical;
+
+    std::cout << ( identical ? "all engines agree" : "ENGINES DISAGREE" ) << std::endl;
+    return identical ? 0 : 1;
+}
@@ -136,7 +136,7 @@ void process_mem_usage(double& vm_usage, double& resident_set)
 /******************************************************************************
  *
  *****************************************************************************/
-bool find_dic( fastdict::FastDict& dic, std::string word, bool verbose )
+bool find_dic( fastdict::FastDict& dic, const std::string& word, bool verbose )
 {
     bool result = false;
     const std::vector<std::string>& words = dic;
@@ -223,6 +223,140 @@ int main( int, char** )
     find_dic( improved, "renht", true );
     find_dic( improved, "ren", true );
 
+    std::cout << "contains_any(aneuronesa) = " << improved.contains_any( "aneuronesa" ) << std::endl;
+    std::cout << "contains_any(ss) = " << improved.contains_any( "ss" ) << std::endl;
+    std::cout << "first_match(suessaures) = " << improved.first_match( "suessaures" ) << std::endl;
+
+    {
+        fastdict::FastDict unloaded;
+        std::cout << "unloaded contains_word(x) = " << unloaded.contains_word( "x" ) << std::endl;
+        std::cout << "unloaded contains_any(x) = " << unloaded.contains_any( "x" ) << std::endl;
+    }
+
+    const uint8_t raw[] = { 'r', 'e', 'n', 'h', 't' };
+    std::cout << "contains_any(raw renht) = " << improved.contains_any( raw, sizeof(raw) ) << std::endl;
+
+    {
+        const fastdict::dea_mask_t food   = 0x1;
+        const fastdict::dea_mask_t colors = 0x2;
+        fastdict::FastDict tagged;
+        tagged.add_list( "demo.txt", food );
+        tagged.add_list( "demo_colors.txt", colors );
+
+        std::string sequence = "gelbe linsensuppe";
+        std::cout << "categories(" << sequence << ") = " << tagged.get_contained_categories( sequence ) << std::endl;
+        for( std::string w : tagged.get_contained_words( sequence, colors ) )
+        {
+            std::cout << "found color " << w << std::endl;
+        }
+        std::cout << "contains_any(linsen, colors) = " << tagged.contains_any( "linsen", colors ) << std::endl;
+
+        const char* buffer = "xxsuppexx linsen";
+        for( std::string w : tagged.get_contained_words( buffer, 7 ) )
+        {
+            std::cout << "found in buffer " << w << std::endl;
+        }
+        std::cout << "contains_any(buffer, 2) = " << tagged.contains_any( buffer, 2 ) << std::endl;
+        std::cout << "contains_any(buffer, 7, colors) = " << tagged.contains_any( buffer, 7, colors ) << std::endl;
+    }
+
+    {
+        fastdict::FastDict compounds;
+        compounds.load_from_list( "demo.txt" );
+        std::vector<std::string> linking = { "n", "s" };
+        std::vector<fastdict::dea_segment_t> parts;
+        for ( std::string w : { "linsensuppenlinseneintopf", "linsensuppeneintopf" } )
+        {
+            std::cout << "segment(" << w << ") =";
+            if ( compounds.segment_word( w, parts, fastdict::DEA_SEGMENT_FEWEST_PARTS, linking ) )
+            {
+                for ( const fastdict::dea_segment_t& part : parts )
+                {
+                    if ( part.link_length > 0 )
+                    {
+                        std::cout << " (" << w.substr( part.offset - part.link_length, part.link_length ) << ")";
+                    }
+                    std::cout << " " << compounds.word_at( part.word_index ) << "@" << part.offset;
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    {
+        fastdict::FastDict anchored;
+        anchored.set_reverse_automaton( true );
+        anchored.load_from_list( "demo.txt" );
+        for( std::string w : anchored.get_anchored_words( "linsensuppentopf", fastdict::DEA_ANCHOR_PREFIX ) )
+        {
+            std::cout << "prefix " << w << std::endl;
+        }
+        for( std::string w : anchored.get_anchored_words( "kartoffelsuppe", fastdict::DEA_ANCHOR_SUFFIX ) )
+        {
+            std::cout << "suffix " << w << std::endl;
+        }
+        std::cout << "contains_anchored(linsen, full) = " << anchored.contains_anchored( "linsen", fastdict::DEA_ANCHOR_FULL ) << std::endl;
+    }
+
+    {
+        fastdict::FastDict folded;
+        folded.load_from_list( "demo.txt", fastdict::FastDict::eFoldCase );
+        for( std::string w : folded.get_contained_words( "Linsensuppe mit SUESSES" ) )
+        {
+            std::cout << "folded found " << w << std::endl;
+        }
+
+        fastdict::FastDict folded_succinct;
+        folded_succinct.load_from_list( "demo.txt", fastdict::FastDict::eFoldCase, fastdict::FastDict::eSuccinct );
+        for( std::string w : folded_succinct.get_contained_words( "Linsensuppe mit SUESSES" ) )
+        {
+            std::cout << "folded succinct found " << w << std::endl;
+        }
+        std::cout << "folded succinct contains_word(LINSEN) = " << folded_succinct.contains_word( "LINSEN" ) << std::endl;
+    }
+
+    {
+        // a worker process would only call attach_shared
+        std::string name = "fastdict_test_" + std::to_string( getpid() );
+        fastdict::FastDict loader( "demo.txt" );
+        loader.load_from_list( "demo.txt" );
+        std::cout << "published generation " << loader.publish_shared( name ) << std::endl;
+
+        fastdict::FastDict worker;
+        if ( worker.attach_shared( name ) )
+        {
+            for( std::string w : worker.get_contained_words( "linsensuppe" ) )
+            {
+                std::cout << "shared found " << w << std::endl;
+            }
+        }
+        fastdict::SharedDict::unpublish( name );
+    }
+
+    {
+        std::vector<std::string> words = { "linsen", "suppe", "topf", "linsen" };
+        fastdict::FastDict in_memory;
+        in_memory.load_words( std::move( words ) );
+        in_memory.add_words( { "eintopf" }, 2 );
+        for( std::string w : in_memory.get_contained_words( "linseneintopf" ) )
+        {
+            std::cout << "in memory found " << w << std::endl;
+        }
+    }
+
+    {
+        fastdict::FastDict limited;
+        limited.load_from_list( "demo.txt" );
+        fastdict::dea_query_limits_t limits;
+        limits.max_matches = 2;
+        fastdict::dea_query_cursor_t cursor;
+        do
+        {
+            std::vector<std::string> found = limited.get_contained_words( "linsensuppenlinseneintopf", limits, cursor );
+            std::cout << "limited found " << found.size() << " words, stopped at " << cursor.offset << " status " << cursor.status << std::endl;
+        } while ( fastdict::DEA_QUERY_COMPLETE != cursor.status );
+    }
+
 
 
     
@@ -0,0 +1,71 @@
+/*!*****************************************************************************
+ * @file record_profile.cpp
+ * @brief records state visits of a training corpus for the profile layout
+ *
+ * @author Christian Kranz
+ *
+ * This file is part of the Fastdict Library.
+ *
+ * The Fastdict Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * The Fastdict Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar. If not, see <https://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#include <fastdict.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+/******************************************************************************
+ * every line of the corpus is scanned as one query
+ *****************************************************************************/
+int main( int argc, char** argv )
+{
+    if ( argc < 4 )
+    {
+        std::cout << "usage: record_profile <word list> <corpus> <profile>\n"
+                  << "load the profile with FastDict::load_state_profile\n";
+        return 1;
+    }
+
+    fastdict::FastDict dict;
+    dict.load_from_list( argv[1] );
+
+    std::ifstream corpus( argv[2] );
+    if ( !corpus )
+    {
+        std::cout << "error read file " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::vector<uint64_t> visits;
+    size_t lines = 0;
+    for ( std::string line; std::getline( corpus, line ); )
+    {
+        dict.record_state_visits( line, visits );
+        lines++;
+    }
+
+    size_t visited = 0;
+    for ( uint64_t count : visits )
+    {
+        if ( 0 != count )
+            visited++;
+    }
+    std::cout << lines << " lines, " << visited << " of " << visits.size() << " states visited" << std::endl;
+
+    return dict.save_state_profile( argv[3], visits ) ? 0 : 1;
+}